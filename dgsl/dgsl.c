@@ -364,6 +364,42 @@ dgsl_rot_mp_t *dgsl_rot_mp_init(const long n, const fmpz_poly_t B, mpfr_t sigma,
 }
 
 
+dgsl_rot_mp_t *dgsl_rot_mp_init_inlattice(const long n, const fmpz_poly_t B, mpfr_t sigma,
+                                          const fmpq_poly_t B_inv, const fmpq_poly_t sigma_sqrt) {
+  assert(mpfr_cmp_ui(sigma, 0) > 0);
+
+  dgsl_rot_mp_t *self = (dgsl_rot_mp_t*)calloc(1, sizeof(dgsl_rot_mp_t));
+  if(!self) dgs_die("out of memory");
+
+  self->n = n;
+  self->prec = mpfr_get_prec(sigma);
+
+  fmpz_poly_init(self->B);
+  fmpz_poly_set(self->B, B);
+  if(fmpz_poly_length(self->B) > n)
+    dgs_die("polynomial is longer than length n");
+  else
+    fmpz_poly_realloc(self->B, n);
+
+  fmpz_poly_init(self->c_z);
+  fmpq_poly_init(self->c);
+
+  mpfr_init2(self->sigma, self->prec);
+  mpfr_set(self->sigma, sigma, MPFR_RNDN);
+
+  fmpq_poly_init(self->B_inv);
+  fmpq_poly_set(self->B_inv, B_inv);
+  fmpq_poly_init(self->sigma_sqrt);
+  fmpq_poly_set(self->sigma_sqrt, sigma_sqrt);
+
+  long r = 2*ceil(sqrt(log(n)));
+  mpfr_init2(self->r_f, self->prec);
+  mpfr_set_ui(self->r_f, r, MPFR_RNDN);
+
+  self->call = dgsl_rot_mp_call_inlattice;
+  return self;
+}
+
 int dgsl_rot_mp_call_identity(fmpz_poly_t rop,  const dgsl_rot_mp_t *self, aes_randstate_t state) {
   assert(rop); assert(self);
 
@@ -385,6 +421,28 @@ int dgsl_rot_mp_call_identity(fmpz_poly_t rop,  const dgsl_rot_mp_t *self, aes_r
   return 0;
 }
 
+int dgsl_rot_mp_call_identity_many(fmpz_poly_t *rop, const size_t m, const dgsl_rot_mp_t *self, aes_randstate_t state) {
+  assert(rop); assert(self);
+  assert(self->call == dgsl_rot_mp_call_identity);
+
+  const long n = self->n;
+  mpz_t  tmp_g;  mpz_init(tmp_g);
+
+  for(size_t j=0; j<m; j++) {
+    fmpz_poly_realloc(rop[j], n);
+    for(long i=0; i<n; i++) {
+      self->D[0]->call(tmp_g, self->D[0], state);
+      fmpz_set_mpz(rop[j]->coeffs + i, tmp_g);
+    }
+    _fmpz_poly_set_length(rop[j], n);
+    _fmpz_poly_normalise(rop[j]);
+  }
+
+  mpz_clear(tmp_g);
+
+  return 0;
+}
+
 int dgsl_rot_mp_call_gpv_inlattice(fmpz_poly_t rop,  const dgsl_rot_mp_t *self, aes_randstate_t state) {
   assert(rop); assert(self);
 
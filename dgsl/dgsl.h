@@ -69,6 +69,18 @@ dgsl_mp_t *dgsl_mp_init(const fmpz_mat_t B, mpfr_t sigma, mpfr_t *c, const dgsl_
 
 dgsl_rot_mp_t *dgsl_rot_mp_init(const long n, const fmpz_poly_t B, mpfr_t sigma, fmpq_poly_t c, const dgsl_alg_t algorithm, const oz_flag_t flags);
 
+/**
+   Initialise a `DGSL_INLATTICE` sampler from the output of a previous call to `dgsl_rot_mp_init`,
+   skipping the approximate inversion of $B$ and `_dgsl_rot_mp_sqrt_sigma_2`.
+
+   @param sigma Gaussian width parameter as stored in `self->sigma` (copied)
+   @param B_inv approximate inverse as stored in `self->B_inv` (copied)
+   @param sigma_sqrt as stored in `self->sigma_sqrt` (copied)
+*/
+
+dgsl_rot_mp_t *dgsl_rot_mp_init_inlattice(const long n, const fmpz_poly_t B, mpfr_t sigma,
+                                          const fmpq_poly_t B_inv, const fmpq_poly_t sigma_sqrt);
+
 /**
    @brief Sample a fresh element from $D_{L,σ}$.
 */
@@ -131,6 +143,19 @@ int dgsl_mp_call_identity(fmpz *rop,  const dgsl_mp_t *self, aes_randstate_t sta
 
 int dgsl_rot_mp_call_identity(fmpz_poly_t rop,  const dgsl_rot_mp_t *self, aes_randstate_t state);
 
+/**
+   Return `m` fresh samples when B is the identity
+
+   All $m·n$ coefficients are drawn in one pass through the same internal sampler.
+
+   @param rop return values (initialised)
+   @param m number of samples
+   @param self sampler with self->call == dgsl_rot_mp_call_identity
+   @param state entropy source
+*/
+
+int dgsl_rot_mp_call_identity_many(fmpz_poly_t *rop, const size_t m, const dgsl_rot_mp_t *self, aes_randstate_t state);
+
 void dgsl_mp_clear(dgsl_mp_t *self);
 
 void dgsl_rot_mp_clear(dgsl_rot_mp_t *self);
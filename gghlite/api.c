@@ -10,10 +10,9 @@ gghlite_enc_init(gghlite_enc_t op, const gghlite_params_t self)
     fmpz_mod_poly_init2(op, self->q, self->n);
 }
 
-void
-gghlite_enc_set_gghlite_clr(gghlite_enc_t rop, const gghlite_sk_t self,
-                            const gghlite_clr_t f, const size_t k, int *group,
-                            const int rerand)
+static void
+_gghlite_enc_set_gghlite_clr0(gghlite_enc_t rop, const gghlite_sk_t self,
+                              const gghlite_clr_t f, const int rerand)
 {
     fmpz_poly_t t_o; fmpz_poly_init(t_o);
     const mp_bitcnt_t prec = (self->params->n/4 < 8192) ? 8192 : self->params->n/4;
@@ -27,67 +26,412 @@ gghlite_enc_set_gghlite_clr(gghlite_enc_t rop, const gghlite_sk_t self,
     fmpz_mod_poly_oz_ntt_enc_fmpz_poly(rop, t_o, self->params->ntt);
 
     fmpz_poly_clear(t_o);
+}
 
-    // encode at level k
-    if(k > 0) {
-        if(!gghlite_sk_is_symmetric(self) && (k>1))
-            ggh_die("Raising to higher levels than 1 not supported. Instead, multiply by the right combination of y_i.");
+static void
+_gghlite_enc_raise_symmetric(gghlite_enc_t rop, const gghlite_sk_t self, const size_t k)
+{
+    // divide by z^k, one multiplication per κ levels
+    for(size_t j=k; j>0; ) {
+        const size_t s = (j < self->params->kappa) ? j : self->params->kappa;
+        _fmpz_mod_poly_oz_ntt_mul(rop, rop, self->z_inv_pow[s-1], self->params->ntt);
+        j -= s;
+    }
+}
+
+static void
+_gghlite_enc_raise_index(gghlite_enc_t rop, const gghlite_sk_t self, const size_t k,
+                         const gghlite_index_t S)
+{
+    if (gghlite_index_is_empty(S))
+        return;
+    gghlite_enc_t z_inv;
+    gghlite_enc_init(z_inv, self->params);
+    _gghlite_sk_get_z_inv(z_inv, self, S, k);
+    _fmpz_mod_poly_oz_ntt_mul(rop, rop, z_inv, self->params->ntt);
+    gghlite_enc_clear(z_inv);
+}
+
+void
+gghlite_enc_set_gghlite_clr(gghlite_enc_t rop, const gghlite_sk_t self,
+                            const gghlite_clr_t f, const size_t k, int *group,
+                            const int rerand)
+{
+    _gghlite_enc_set_gghlite_clr0(rop, self, f, rerand);
 
-        for (unsigned int r = 0; r < self->params->gamma; r++) {
+    // encode at level k
+    if (k == 0)
+        return;
+    if (gghlite_sk_is_symmetric(self)) {
+        for (size_t r = 0; r < self->params->gamma; r++) {
             if (group[r]) {
-                if(gghlite_sk_is_symmetric(self)) {
-                    for(size_t j=0; j<k; j++) // divide by z_i^k
-                        fmpz_mod_poly_oz_ntt_mul(rop, rop, self->z_inv[r], self->params->n);
-                    break;
-                } else {
-                    fmpz_mod_poly_oz_ntt_mul(rop, rop, self->z_inv[r], self->params->n);
-                }
+                _gghlite_enc_raise_symmetric(rop, self, k);
+                break;
             }
         }
+    } else {
+        gghlite_index_t S;
+        gghlite_index_init(S, self->params->gamma);
+        gghlite_index_set_group(S, group);
+        _gghlite_enc_raise_index(rop, self, k, S);
+        gghlite_index_clear(S);
     }
 }
 
-int
-gghlite_enc_is_zero(const gghlite_params_t self, const fmpz_mod_poly_t op)
+void
+gghlite_enc_set_gghlite_clr_index(gghlite_enc_t rop, const gghlite_sk_t self,
+                                  const gghlite_clr_t f, const size_t k, const gghlite_index_t S,
+                                  const int rerand)
 {
-    gghlite_clr_t t;
-    mpfr_t norm, bound;
-    int r;
+    _gghlite_enc_set_gghlite_clr0(rop, self, f, rerand);
 
-    gghlite_clr_init(t);
-    _gghlite_enc_extract_raw(t, self, op);
+    if (k == 0)
+        return;
+    if (gghlite_sk_is_symmetric(self))
+        _gghlite_enc_raise_symmetric(rop, self, k);
+    else
+        _gghlite_enc_raise_index(rop, self, k, S);
+}
+
+void
+gghlite_enc_rerand(gghlite_enc_t rop, const gghlite_params_t self, const gghlite_enc_t op,
+                   size_t k, size_t i, aes_randstate_t randstate)
+{
+    assert(k >= 1 && k <= self->kappa);
+    if (!self->x || !gghlite_params_have_rerand(self, k-1))
+        ggh_die("No re-randomisers available at level %zu.", k);
+    if (gghlite_params_is_symmetric(self))
+        i = 0;
+    assert(i < self->gamma);
+
+    gghlite_clr_t rho[2];
+    gghlite_enc_t t[2];
+    for(size_t j=0; j<2; j++) {
+        gghlite_clr_init(rho[j]);
+        gghlite_enc_init(t[j], self);
+    }
+
+    /* ρ_j ← D_{R,σ^*}, both drawn in one go */
+    dgsl_rot_mp_call_identity_many(rho, 2, self->D_sigma_s, randstate);
+    for(size_t j=0; j<2; j++)
+        fmpz_mod_poly_oz_ntt_enc_fmpz_poly(t[j], rho[j], self->ntt);
+
+    _fmpz_mod_poly_oz_ntt_dot(t[0], t, self->x[i][k-1], 2, self->ntt);
+    fmpz_mod_poly_add(rop, op, t[0]);
+
+    for(size_t j=0; j<2; j++) {
+        gghlite_clr_clear(rho[j]);
+        gghlite_enc_clear(t[j]);
+    }
+}
+
+void
+gghlite_enc_raise(gghlite_enc_t rop, const gghlite_params_t self, const gghlite_enc_t op,
+                  size_t l, size_t k, size_t i,
+                  int rerand, aes_randstate_t randstate)
+{
+    assert(k <= l);
+    assert(l <= self->kappa);
+    if (gghlite_params_is_symmetric(self))
+        i = 0;
+    assert(i < self->gamma);
+
+    if (l > k) {
+        if (!self->y)
+            ggh_die("No level-1 encodings of 1 available, rerand_mask is zero.");
+        gghlite_enc_t t;
+        gghlite_enc_init(t, self);
+        _fmpz_mod_poly_oz_ntt_pow_ui(t, self->y[i], l-k, self->ntt);
+        _fmpz_mod_poly_oz_ntt_mul(rop, op, t, self->ntt);
+        gghlite_enc_clear(t);
+    } else {
+        gghlite_enc_set(rop, op);
+    }
+
+    if (rerand)
+        gghlite_enc_rerand(rop, self, rop, l, i, randstate);
+}
+
+void
+gghlite_enc_sample(gghlite_enc_t rop, const gghlite_params_t self, size_t k, size_t i,
+                   aes_randstate_t randstate)
+{
+    assert(self->D_sigma_p);
+
+    /* level-0 encoding of a random coset, e ← D_{R,σ'} */
+    gghlite_clr_t e;
+    gghlite_clr_init(e);
+    fmpz_poly_sample_D(e, self->D_sigma_p, randstate);
+    fmpz_mod_poly_oz_ntt_enc_fmpz_poly(rop, e, self->ntt);
+    gghlite_clr_clear(e);
+
+    if (k > 0)
+        gghlite_enc_raise(rop, self, rop, k, 0, i, gghlite_params_have_rerand(self, k-1), randstate);
+}
+
+/**
+   Return 1 if the centred lift of `c` has $\ell_2$ norm at most @f$q^{1-ξ}@f$. Coefficients may be
+   given in $[0,q)$ or already centred. Random elements have coefficients of size about $q$, so we
+   check the bit size of each coefficient first and stop as soon as the partial sum of squares
+   exceeds the bound.
+*/
+
+static int
+_gghlite_is_small(const gghlite_params_t self, const fmpz *c, const long len)
+{
+    fmpz_t q2, a, acc;
+    int r = 1;
+
+    assert(!fmpz_is_zero(self->zt_bound2));
+
+    fmpz_init(q2);
+    fmpz_init(a);
+    fmpz_init(acc);
+    fmpz_fdiv_q_2exp(q2, self->q, 1);
+
+    for (long i = 0; i < len; i++) {
+        if (fmpz_sgn(c + i) < 0)
+            fmpz_neg(a, c + i);
+        else if (fmpz_cmp(c + i, q2) >= 0)
+            fmpz_sub(a, self->q, c + i);
+        else
+            fmpz_set(a, c + i);
+
+        if (fmpz_bits(a) > self->zt_bound_bits) {
+            r = 0;
+            break;
+        }
+        fmpz_addmul(acc, a, a);
+        if (fmpz_cmp(acc, self->zt_bound2) > 0) {
+            r = 0;
+            break;
+        }
+    }
+
+    fmpz_clear(acc);
+    fmpz_clear(a);
+    fmpz_clear(q2);
+    return r;
+}
 
-    mpfr_init2(norm, _gghlite_prec(self));
-    mpfr_init2(bound, _gghlite_prec(self));
-    fmpz_poly_2norm_mpfr(norm, t, MPFR_RNDN);
+static int
+_gghlite_clr_is_small(const gghlite_params_t self, const gghlite_clr_t t)
+{
+    return _gghlite_is_small(self, t->coeffs, fmpz_poly_length(t));
+}
+
+/**
+   As `_gghlite_is_small` for the $n$ coefficients in $[0,q)$ held in the limb array `a`.
+*/
+
+static int
+_gghlite_mpn_is_small(const gghlite_params_t self, mp_srcptr a)
+{
+    const mp_size_t l = self->ntt->mont->nlimbs;
+    mp_limb_t q2[l];
+    mp_limb_t x[l];
+    fmpz_t c, acc;
+    int r = 1;
+
+    _fmpz_oz_get_mpn(q2, l, self->q);
+    mpn_rshift(q2, q2, l, 1);
+    fmpz_init(c);
+    fmpz_init(acc);
+
+    for (long i = 0; i < self->n; i++) {
+        mp_srcptr ai = a + i*l;
+        if (mpn_cmp(ai, q2, l) >= 0)
+            mpn_sub_n(x, self->ntt->mont->q, ai, l);
+        else
+            mpn_copyi(x, ai, l);
+
+        mp_size_t s = l;
+        while (s > 0 && x[s-1] == 0)
+            s--;
+        if (s && (mp_bitcnt_t)mpn_sizeinbase(x, s, 2) > self->zt_bound_bits) {
+            r = 0;
+            break;
+        }
+        _fmpz_oz_set_mpn(c, x, l);
+        fmpz_addmul(acc, c, c);
+        if (fmpz_cmp(acc, self->zt_bound2) > 0) {
+            r = 0;
+            break;
+        }
+    }
+
+    fmpz_clear(acc);
+    fmpz_clear(c);
+    return r;
+}
+
+static mp_ptr
+_gghlite_enc_scratch(const gghlite_params_t self)
+{
+    const size_t len = self->n * self->ntt->mont->nlimbs;
+    mp_ptr a = (mp_ptr)malloc(len * sizeof(mp_limb_t));
+    if (a == NULL)
+        ggh_die("failed to allocate %zu limbs", len);
+    return a;
+}
+
+/**
+   Write $f_i - g_i \bmod q ∈ [0,q)$ to `x`, `g` may be `NULL`. Lazily reduced inputs are accepted.
+*/
+
+static inline void
+_gghlite_enc_get_diff_mpn(mp_ptr x, mp_ptr y, const gghlite_enc_t f, const gghlite_enc_t g,
+                          const size_t i, const gghlite_params_t self, fmpz_t tmp)
+{
+    const mp_size_t l = self->ntt->mont->nlimbs;
+    const fmpz *c = (i < (size_t)f->length) ? f->coeffs + i : NULL;
+
+    if (c && (fmpz_sgn(c) < 0 || fmpz_cmp(c, self->q) >= 0)) {
+        fmpz_mod(tmp, c, self->q);
+        c = tmp;
+    }
+    if (c)
+        _fmpz_oz_get_mpn(x, l, c);
+    else
+        mpn_zero(x, l);
+
+    c = (g && i < (size_t)g->length) ? g->coeffs + i : NULL;
+    if (c == NULL || fmpz_is_zero(c))
+        return;
+    if (fmpz_sgn(c) < 0 || fmpz_cmp(c, self->q) >= 0) {
+        fmpz_mod(tmp, c, self->q);
+        c = tmp;
+    }
+    _fmpz_oz_get_mpn(y, l, c);
+    _fmpz_oz_mont_sub(x, x, y, self->ntt->mont);
+}
+
+/**
+   Return 1 if $f - g$ encodes zero, `g` may be `NULL`. `a` is scratch space of $n·\ell$ limbs.
+*/
+
+static int
+_gghlite_enc_is_zero_diff(const gghlite_params_t self, const gghlite_enc_t f, const gghlite_enc_t g,
+                          mp_ptr a)
+{
+    const size_t n = self->n;
+    const mp_size_t l = self->ntt->mont->nlimbs;
+    const int nthreads = _fmpz_mod_poly_oz_ntt_nthreads(self->ntt);
+    int r = 1;
+
+    if (self->zt_nrows) {
+        /* a few coefficients of [p_zt·(f-g)]_q in O(n) each, a large one shows f-g is not zero */
+        fmpz *c = _fmpz_vec_init(self->zt_nrows);
+        fmpz_t t;
+        fmpz_init(t);
+        for (size_t i = 0; i < self->zt_nrows; i++) {
+            _fmpz_mod_poly_oz_ntt_dec_coeff(c + i, f, self->zt_rows + i*n*l, self->ntt);
+            if (g) {
+                _fmpz_mod_poly_oz_ntt_dec_coeff(t, g, self->zt_rows + i*n*l, self->ntt);
+                fmpz_sub(c + i, c + i, t);
+                fmpz_mod(c + i, c + i, self->q);
+            }
+        }
+        r = _gghlite_is_small(self, c, self->zt_nrows);
+        fmpz_clear(t);
+        _fmpz_vec_clear(c, self->zt_nrows);
+        if (!r)
+            return 0;
+    }
 
+#pragma omp parallel num_threads(nthreads) if(nthreads > 1)
     {
-        /* Set bound = q */
-        mpz_t q_z;
-        mpz_init(q_z);
-        fmpz_get_mpz(q_z, self->q);
-        mpfr_set_z(bound, q_z, MPFR_RNDN);
-        mpz_clear(q_z);
+        mp_limb_t t[2*l];
+        mp_limb_t x[l];
+        mp_limb_t y[l];
+        fmpz_t tmp;
+        fmpz_init(tmp);
+#pragma omp for
+        for (size_t i = 0; i < n; i++) {
+            _gghlite_enc_get_diff_mpn(x, y, f, g, i, self, tmp);
+            _fmpz_oz_mont_mul(a + i*l, x, self->pzt_mpn->coeffs + i*l, t, self->ntt->mont);
+        }
+        fmpz_clear(tmp);
     }
+    _mpn_oz_ntt_dec(a, self->ntt);
+    return _gghlite_mpn_is_small(self, a);
+}
+
+int
+gghlite_enc_is_zero(const gghlite_params_t self, const fmpz_mod_poly_t op)
+{
+    mp_ptr a = _gghlite_enc_scratch(self);
+    const int r = _gghlite_enc_is_zero_diff(self, op, NULL, a);
+    free(a);
+    return r;
+}
+
+int
+gghlite_enc_equal(const gghlite_params_t self, const gghlite_enc_t f, const gghlite_enc_t g)
+{
+    mp_ptr a = _gghlite_enc_scratch(self);
+    const int r = _gghlite_enc_is_zero_diff(self, f, g, a);
+    free(a);
+    return r;
+}
 
+void
+gghlite_enc_is_zero_batch(int *rop, const gghlite_params_t self, gghlite_enc_t *ops, const size_t len)
+{
+    /* one encoding per thread, the kernels of each test see an active parallel region and hence
+       run on that thread only, cf. _fmpz_mod_poly_oz_ntt_nthreads */
+    const int nthreads = omp_in_parallel() ? 1 : self->ntt->nthreads;
+#pragma omp parallel num_threads(nthreads) if(nthreads > 1 && len > 1)
     {
-        /* compute q^{1-xi} */
-        mpfr_t ex;
-        mpfr_init2(ex, _gghlite_prec(self));
-        mpfr_set_ui(ex, 1, MPFR_RNDN);
-        mpfr_sub(ex, ex, self->xi, MPFR_RNDN);
-        mpfr_pow(bound, bound, ex, MPFR_RNDN);
-        mpfr_clear(ex);
+        mp_ptr a = _gghlite_enc_scratch(self);
+#pragma omp for schedule(dynamic)
+        for (size_t i = 0; i < len; i++)
+            rop[i] = _gghlite_enc_is_zero_diff(self, ops[i], NULL, a);
+        free(a);
     }
+}
 
-    r = mpfr_cmp(norm, bound);
+void
+gghlite_enc_rns_init(gghlite_enc_rns_t op, const gghlite_params_t self)
+{
+    assert(gghlite_params_is_rns(self));
+    fmpz_mod_poly_oz_rns_init(op, self->rns);
+}
+
+int
+gghlite_enc_rns_is_zero(const gghlite_params_t self, const gghlite_enc_rns_t op)
+{
+    gghlite_clr_t t;
+    int r;
 
-    mpfr_clear(bound);
-    mpfr_clear(norm);
+    gghlite_clr_init(t);
+    _gghlite_enc_rns_extract_raw(t, self, op);
+    r = _gghlite_clr_is_small(self, t);
     gghlite_clr_clear(t);
+    return r;
+}
 
-    if (r <= 0)
-        return 1;
-    else
-        return 0;
+int
+gghlite_enc_mpn_is_zero(const gghlite_params_t self, const gghlite_enc_mpn_view_t op)
+{
+    const size_t n = self->n;
+    const mp_size_t l = self->ntt->mont->nlimbs;
+    const int nthreads = _fmpz_mod_poly_oz_ntt_nthreads(self->ntt);
+    mp_ptr a = _gghlite_enc_scratch(self);
+
+    /* both factors are in Montgomery representation, take op out of it so the product is not */
+#pragma omp parallel num_threads(nthreads) if(nthreads > 1)
+    {
+        mp_limb_t t[2*l];
+        mp_limb_t x[l];
+#pragma omp for
+        for (size_t i = 0; i < n; i++) {
+            _fmpz_oz_mont_get(x, op->coeffs + i*l, t, self->ntt->mont);
+            _fmpz_oz_mont_mul(a + i*l, x, self->pzt_mpn->coeffs + i*l, t, self->ntt->mont);
+        }
+    }
+    _mpn_oz_ntt_dec(a, self->ntt);
+    const int r = _gghlite_mpn_is_small(self, a);
+    free(a);
+    return r;
 }
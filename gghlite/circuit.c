@@ -0,0 +1,325 @@
+#include "gghlite.h"
+
+void
+gghlite_circuit_init(gghlite_circuit_t self, const size_t ninputs)
+{
+    memset(self, 0, sizeof(struct _gghlite_circuit_struct));
+    self->ninputs = ninputs;
+    self->nnodes = ninputs;
+    self->alloc = (ninputs < 16) ? 16 : ninputs;
+    self->nodes = (struct _gghlite_circuit_node_struct*)calloc(self->alloc, sizeof(struct _gghlite_circuit_node_struct));
+    self->htab_size = 64;
+    self->htab = (size_t*)calloc(self->htab_size, sizeof(size_t));
+    if (self->nodes == NULL || self->htab == NULL)
+        ggh_die("failed to allocate circuit on %zu inputs", ninputs);
+
+    for(size_t i=0; i<ninputs; i++) {
+        self->nodes[i].op = GGHLITE_CIRCUIT_INPUT;
+        self->nodes[i].a = i;
+    }
+}
+
+void
+gghlite_circuit_clear(gghlite_circuit_t self)
+{
+    free(self->nodes);
+    free(self->outputs);
+    free(self->htab);
+    free(self->order);
+    free(self->levels);
+    memset(self, 0, sizeof(struct _gghlite_circuit_struct));
+}
+
+static inline size_t
+_gghlite_circuit_hash(const gghlite_circuit_op_t op, const size_t a, const size_t b)
+{
+    uint64_t h = (uint64_t)op;
+    h = (h ^ (uint64_t)a) * 0x9e3779b97f4a7c15ULL;
+    h = (h ^ (uint64_t)b) * 0xff51afd7ed558ccdULL;
+    return (size_t)(h ^ (h >> 32));
+}
+
+static void
+_gghlite_circuit_htab_insert(size_t *htab, const size_t size, const struct _gghlite_circuit_node_struct *node,
+                             const size_t v)
+{
+    size_t j = _gghlite_circuit_hash(node->op, node->a, node->b) & (size - 1);
+    while (htab[j])
+        j = (j + 1) & (size - 1);
+    htab[j] = v + 1;
+}
+
+static void
+_gghlite_circuit_htab_grow(gghlite_circuit_t self)
+{
+    const size_t size = 2*self->htab_size;
+    size_t *htab = (size_t*)calloc(size, sizeof(size_t));
+    if (htab == NULL)
+        ggh_die("failed to allocate %zu entries", size);
+    for(size_t v=self->ninputs; v<self->nnodes; v++)
+        _gghlite_circuit_htab_insert(htab, size, self->nodes + v, v);
+    free(self->htab);
+    self->htab = htab;
+    self->htab_size = size;
+}
+
+size_t
+gghlite_circuit_node(gghlite_circuit_t self, const gghlite_circuit_op_t op, size_t a, size_t b)
+{
+    if (op == GGHLITE_CIRCUIT_INPUT)
+        ggh_die("inputs are created by gghlite_circuit_init");
+    if (a >= self->nnodes || b >= self->nnodes)
+        ggh_die("node %zu is out of range", (a >= self->nnodes) ? a : b);
+
+    if (op != GGHLITE_CIRCUIT_SUB && a > b) {
+        const size_t t = a;
+        a = b;
+        b = t;
+    }
+
+    const size_t mask = self->htab_size - 1;
+    for(size_t j = _gghlite_circuit_hash(op, a, b) & mask; self->htab[j]; j = (j + 1) & mask) {
+        const struct _gghlite_circuit_node_struct *node = self->nodes + self->htab[j] - 1;
+        if (node->op == op && node->a == a && node->b == b)
+            return self->htab[j] - 1;
+    }
+
+    if (self->nnodes == self->alloc) {
+        self->alloc *= 2;
+        self->nodes = (struct _gghlite_circuit_node_struct*)realloc(self->nodes, self->alloc * sizeof(struct _gghlite_circuit_node_struct));
+        if (self->nodes == NULL)
+            ggh_die("failed to allocate %zu nodes", self->alloc);
+    }
+
+    const size_t v = self->nnodes++;
+    struct _gghlite_circuit_node_struct *node = self->nodes + v;
+    memset(node, 0, sizeof(struct _gghlite_circuit_node_struct));
+    node->op = op;
+    node->a = a;
+    node->b = b;
+    node->depth = 1 + ((self->nodes[a].depth > self->nodes[b].depth) ? self->nodes[a].depth : self->nodes[b].depth);
+
+    if (2*(self->nnodes - self->ninputs) > self->htab_size)
+        _gghlite_circuit_htab_grow(self);
+    else
+        _gghlite_circuit_htab_insert(self->htab, self->htab_size, node, v);
+
+    self->compiled = 0;
+    return v;
+}
+
+size_t
+gghlite_circuit_output(gghlite_circuit_t self, const size_t a)
+{
+    if (a >= self->nnodes)
+        ggh_die("node %zu is out of range", a);
+
+    if (self->noutputs == self->outputs_alloc) {
+        self->outputs_alloc = (self->outputs_alloc) ? 2*self->outputs_alloc : 16;
+        self->outputs = (size_t*)realloc(self->outputs, self->outputs_alloc * sizeof(size_t));
+        if (self->outputs == NULL)
+            ggh_die("failed to allocate %zu outputs", self->outputs_alloc);
+    }
+    self->outputs[self->noutputs] = a;
+    self->compiled = 0;
+    return self->noutputs++;
+}
+
+/**
+   Drop nodes not reaching an output, decide which nodes are computed lazily, group nodes by depth
+   and assign buffers by liveness.
+*/
+
+static void
+_gghlite_circuit_compile(gghlite_circuit_t self)
+{
+    struct _gghlite_circuit_node_struct *nodes = self->nodes;
+    const size_t ninputs = self->ninputs;
+    const size_t nnodes = self->nnodes;
+
+    int *strict = (int*)calloc(nnodes, sizeof(int));
+    for(size_t v=0; v<nnodes; v++) {
+        nodes[v].live = 0;
+        nodes[v].lazy = 0;
+        nodes[v].last = 0;
+        nodes[v].slot = 0;
+    }
+    for(size_t j=0; j<self->noutputs; j++) {
+        const size_t v = self->outputs[j];
+        nodes[v].live = 1;
+        nodes[v].last = SIZE_MAX;
+        strict[v] = 1;
+    }
+
+    /* readers follow the nodes they read, so one backward pass visits every reader first */
+    size_t nlevels = 0;
+    size_t count = 0;
+    for(size_t v=nnodes; v-- > ninputs; ) {
+        struct _gghlite_circuit_node_struct *node = nodes + v;
+        if (!node->live)
+            continue;
+        count++;
+        if (node->depth > nlevels)
+            nlevels = node->depth;
+        node->lazy = (node->op != GGHLITE_CIRCUIT_MUL) && !strict[v];
+        const size_t ops[2] = {node->a, node->b};
+        for(int k=0; k<2; k++) {
+            struct _gghlite_circuit_node_struct *operand = nodes + ops[k];
+            operand->live = 1;
+            if (operand->last < node->depth)
+                operand->last = node->depth;
+            if (node->op != GGHLITE_CIRCUIT_MUL && !node->lazy)
+                strict[ops[k]] = 1;
+        }
+    }
+    free(strict);
+
+    /* sort live nodes by depth and by the depth of their last reader */
+    free(self->order);
+    free(self->levels);
+    self->order = (size_t*)malloc((count + 1) * sizeof(size_t));
+    self->levels = (size_t*)calloc(nlevels + 2, sizeof(size_t));
+    size_t *release = (size_t*)malloc((count + 1) * sizeof(size_t));
+    size_t *release_start = (size_t*)calloc(nlevels + 2, sizeof(size_t));
+    size_t *free_slots = (size_t*)malloc((count + 1) * sizeof(size_t));
+    if (!self->order || !self->levels || !release || !release_start || !free_slots)
+        ggh_die("failed to allocate schedule of %zu nodes", count);
+
+    for(size_t v=ninputs; v<nnodes; v++) {
+        if (!nodes[v].live)
+            continue;
+        self->levels[nodes[v].depth]++;
+        if (nodes[v].last != SIZE_MAX)
+            release_start[nodes[v].last]++;
+    }
+    for(size_t d=1; d<=nlevels+1; d++) {
+        self->levels[d] += self->levels[d-1];
+        release_start[d] += release_start[d-1];
+    }
+    for(size_t v=nnodes; v-- > ninputs; ) {
+        if (!nodes[v].live)
+            continue;
+        self->order[--self->levels[nodes[v].depth]] = v;
+        if (nodes[v].last != SIZE_MAX)
+            release[--release_start[nodes[v].last]] = v;
+    }
+    /* levels[d] is now the start of depth d, shift so that levels[d] is the start of depth d+1 */
+    memmove(self->levels, self->levels + 1, (nlevels + 1) * sizeof(size_t));
+    self->nlevels = nlevels;
+
+    /* buffers read for the last time at depth d become free once depth d is done */
+    size_t nfree = 0;
+    self->nslots = 0;
+    for(size_t d=1; d<=nlevels; d++) {
+        for(size_t j=self->levels[d-1]; j<self->levels[d]; j++)
+            nodes[self->order[j]].slot = (nfree) ? free_slots[--nfree] : self->nslots++;
+        for(size_t j=release_start[d]; j<release_start[d+1]; j++)
+            free_slots[nfree++] = nodes[release[j]].slot;
+    }
+
+    free(free_slots);
+    free(release_start);
+    free(release);
+    self->compiled = 1;
+}
+
+static inline const fmpz_mod_poly_struct *
+_gghlite_circuit_value(const gghlite_circuit_t self, gghlite_enc_t *buf, gghlite_enc_t *inputs, const size_t v)
+{
+    const struct _gghlite_circuit_node_struct *node = self->nodes + v;
+    return (node->op == GGHLITE_CIRCUIT_INPUT) ? inputs[node->a] : buf[node->slot];
+}
+
+static void
+_gghlite_circuit_eval_node(const gghlite_params_t params, const gghlite_circuit_t self,
+                           gghlite_enc_t *buf, gghlite_enc_t *inputs, const size_t v)
+{
+    const struct _gghlite_circuit_node_struct *node = self->nodes + v;
+    const fmpz_mod_poly_struct *a = _gghlite_circuit_value(self, buf, inputs, node->a);
+    const fmpz_mod_poly_struct *b = _gghlite_circuit_value(self, buf, inputs, node->b);
+    fmpz_mod_poly_struct *rop = buf[node->slot];
+
+    switch(node->op) {
+    case GGHLITE_CIRCUIT_ADD:
+        if (node->lazy)
+            gghlite_enc_add_lazy(rop, params, a, b);
+        else
+            gghlite_enc_add(rop, params, a, b);
+        break;
+    case GGHLITE_CIRCUIT_SUB:
+        if (node->lazy)
+            gghlite_enc_sub_lazy(rop, params, a, b);
+        else
+            gghlite_enc_sub(rop, params, a, b);
+        break;
+    case GGHLITE_CIRCUIT_MUL:
+        gghlite_enc_mul(rop, params, a, b);
+        break;
+    default:
+        ggh_die("unknown circuit operation %d", (int)node->op);
+    }
+}
+
+void
+gghlite_circuit_eval(gghlite_enc_t *rop, const gghlite_params_t params, gghlite_circuit_t self,
+                     gghlite_enc_t *inputs)
+{
+    if (!self->compiled)
+        _gghlite_circuit_compile(self);
+
+    gghlite_enc_t *buf = (gghlite_enc_t*)calloc(self->nslots + 1, sizeof(gghlite_enc_t));
+    size_t *emitted = (size_t*)malloc((self->nslots + 1) * sizeof(size_t));
+    if (buf == NULL || emitted == NULL)
+        ggh_die("failed to allocate %zu encodings", self->nslots);
+    for(size_t s=0; s<self->nslots; s++) {
+        gghlite_enc_init(buf[s], params);
+        emitted[s] = SIZE_MAX;
+    }
+
+    /* nodes of one depth are independent, the kernels of each node see an active parallel region
+       and hence run on its thread only, cf. _fmpz_mod_poly_oz_ntt_nthreads */
+    const int nthreads = omp_in_parallel() ? 1 : params->ntt->nthreads;
+    for(size_t d=0; d<self->nlevels; d++) {
+        const size_t start = self->levels[d];
+        const size_t end = self->levels[d+1];
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads) if(nthreads > 1 && end - start > 1)
+        for(size_t j=start; j<end; j++)
+            _gghlite_circuit_eval_node(params, self, buf, inputs, self->order[j]);
+    }
+
+    /* move each result out of its buffer once, copy repeated outputs */
+    for(size_t j=0; j<self->noutputs; j++) {
+        const struct _gghlite_circuit_node_struct *node = self->nodes + self->outputs[j];
+        if (node->op == GGHLITE_CIRCUIT_INPUT) {
+            fmpz_mod_poly_set(rop[j], inputs[node->a]);
+        } else if (emitted[node->slot] != SIZE_MAX) {
+            fmpz_mod_poly_set(rop[j], rop[emitted[node->slot]]);
+        } else {
+            fmpz_mod_poly_swap(rop[j], buf[node->slot]);
+            emitted[node->slot] = j;
+        }
+    }
+
+    for(size_t s=0; s<self->nslots; s++)
+        gghlite_enc_clear(buf[s]);
+    free(emitted);
+    free(buf);
+}
+
+void
+gghlite_circuit_eval_is_zero(int *rop, const gghlite_params_t params, gghlite_circuit_t self,
+                             gghlite_enc_t *inputs)
+{
+    gghlite_enc_t *out = (gghlite_enc_t*)calloc(self->noutputs + 1, sizeof(gghlite_enc_t));
+    if (out == NULL)
+        ggh_die("failed to allocate %zu encodings", self->noutputs);
+    for(size_t j=0; j<self->noutputs; j++)
+        gghlite_enc_init(out[j], params);
+
+    gghlite_circuit_eval(out, params, self, inputs);
+    gghlite_enc_is_zero_batch(rop, params, out, self->noutputs);
+
+    for(size_t j=0; j<self->noutputs; j++)
+        gghlite_enc_clear(out[j]);
+    free(out);
+}
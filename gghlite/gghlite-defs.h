@@ -27,6 +27,120 @@ typedef fmpz_poly_t     gghlite_clr_t;
 
 typedef fmpz_mod_poly_t gghlite_enc_t;
 
+/**
+   If `GGHLITE_FLAGS_RNS` is set, encodings may also be held as residues of the NTT domain modulo
+   each word-sized prime factor $p_i$ of $q$. Multiplication, addition and subtraction then only
+   require single-word arithmetic.
+**/
+
+typedef fmpz_mod_poly_oz_rns_t gghlite_enc_rns_t;
+
+/**
+   Encodings may also be held as one contiguous block of limbs, cf. @ref mpn.h. This avoids one heap
+   allocation per coefficient and allows copying with a single `memcpy`.
+**/
+
+typedef fmpz_mod_poly_oz_mpn_t gghlite_enc_mpn_t;
+
+/**
+   Read-only views of such blocks which do not own their limbs, e.g. encodings in a mapped store.
+   Owned encodings are passed as views through their `view` member.
+**/
+
+typedef fmpz_mod_poly_oz_mpn_view_t gghlite_enc_mpn_view_t;
+
+/**
+   @brief Matrix of encodings, stored row by row.
+*/
+
+struct _gghlite_enc_mat_struct {
+    size_t nrows;            //!< number of rows
+    size_t ncols;            //!< number of columns
+    gghlite_enc_t *entries;  //!< `nrows·ncols` encodings, entry $(i,j)$ at index $i·$`ncols`$+j$
+};
+
+typedef struct _gghlite_enc_mat_struct gghlite_enc_mat_t[1];
+
+/**
+   @brief Number of rows and columns of the tiles of a matrix product handed to one thread, cf.
+   @ref gghlite_enc_mat_mul.
+*/
+
+#define GGHLITE_ENC_MAT_BLOCK 4
+
+
+/**
+   @brief Number of coefficients of $[p_{zt}·e]_q$ computed directly before a full zero-test if
+   `GGHLITE_FLAGS_ZT_PRECHECK` is set.
+*/
+
+#define GGHLITE_ZT_PRECHECK_NROWS 2
+
+/**
+   Index sets $S ⊆ \\{0, …, γ-1\\}$ of asymmetric encodings are represented as bitsets with bit
+   $i$ set iff $i ∈ S$.
+**/
+
+struct _gghlite_index_struct {
+    size_t gamma;    //!< size $γ$ of the index universe
+    uint64_t *bits;  //!< $\\lceil γ/64 \\rceil$ words, bit $i$ is set iff $i ∈ S$
+};
+
+typedef struct _gghlite_index_struct gghlite_index_t[1];
+
+/**
+   @brief Maximum number of products @f$\prod_{i ∈ S} z_i^{-k}@f$ held in the cache of a secret key.
+*/
+
+#define GGHLITE_ZCACHE_SIZE 64
+
+/**
+   @brief First bytes of files written by @ref gghlite_params_save and @ref gghlite_sk_save.
+*/
+
+#define GGHLITE_FILE_MAGIC "GGHLITE\n"
+
+/**
+   @brief Version of the file format, files of any other version are rejected.
+*/
+
+#define GGHLITE_FILE_VERSION 1
+
+/**
+   @brief Alignment in bytes of the limb arrays in files written by @ref gghlite_params_save_mappable,
+   matches `OZ_MPN_ALIGN`.
+*/
+
+#define GGHLITE_MAP_ALIGN 64
+
+/**
+   @brief Number of coefficients packed per chunk by @ref gghlite_enc_pack_fd and @ref
+   gghlite_enc_unpack_fd, must be a multiple of 8.
+*/
+
+#define GGHLITE_PACK_CHUNK 1024
+
+/**
+   @brief Entry of the cache of products @f$\prod_{i ∈ S} z_i^{-k}@f$.
+*/
+
+struct _gghlite_zcache_entry_struct {
+    gghlite_index_t S;     //!< index set $S$
+    size_t k;              //!< level $k$
+    gghlite_enc_t z_inv;   //!< @f$\prod_{i ∈ S} z_i^{-k}@f$ in the NTT domain
+    uint64_t used;         //!< time stamp of last use
+};
+
+/**
+   @brief Bounded least-recently-used cache of products @f$\prod_{i ∈ S} z_i^{-k}@f$.
+*/
+
+struct _gghlite_zcache_struct {
+    size_t size;    //!< maximum number of entries
+    size_t len;     //!< number of initialised entries
+    uint64_t clock; //!< time stamp of last access
+    struct _gghlite_zcache_entry_struct *entries; //!< `size` entries of which the first `len` are initialised
+};
 
 /**
    @brief Flags controlling GGHLite behaviour
@@ -41,6 +155,10 @@ typedef enum {
     GGHLITE_FLAGS_QUIET      = 0x10, //!< suppress printing
     GGHLITE_FLAGS_GOOD_G_INV = 0x20, /*!< produce an inverse of $g$ with high-precision,
                                        set this if you plan to call gghlite_enc_set_gghlite_clr */
+    GGHLITE_FLAGS_RNS        = 0x40, //!< pick $q$ as a product of word-sized primes, cf. @ref gghlite_enc_rns_t
+    GGHLITE_FLAGS_ZT_PRECHECK = 0x80, //!< zero-test `GGHLITE_ZT_PRECHECK_NROWS` random coefficients first, cf. @ref gghlite_enc_is_zero
+    GGHLITE_FLAGS_NTT_COMPACT = 0x100, //!< do not store power tables in the NTT pre-computation, cf. `OZ_NTT_COMPACT`
+    GGHLITE_FLAGS_NTT_SEEDED  = 0x200, //!< regenerate NTT twiddle factors from small seed tables, cf. `OZ_NTT_SEEDED`
 } gghlite_flag_t;
 
 /**
@@ -71,13 +189,27 @@ struct _gghlite_params_struct {
     mpfr_t ell_b;      //!< bound $ℓ_b$ on $σ_n(rot(B^(k)))$
     mpfr_t ell_g;      //!< bound $ℓ_g$ on $|g^-1|$
     mpfr_t xi;         //!< fraction $ξ$ of $q$ used for zero-testing
-    gghlite_enc_t pzt; //!< zero-testing parameter $p_{zt}$
-    /* gghlite_enc_t ***x; /\*!< @brief level-$k$ encodings of zero $x_{i,k,j}$ for each source */
-    /*                         group $G_i$, level $k$ specified by rerand mask *\/ */
-    /* gghlite_enc_t *y; //!< one level-1 encodings of 1 (for each source group $G_i$) */
-    /* dgsl_rot_mp_t *D_sigma_p; //!< discrete Gaussian distribution $D_{\\ZZ,σ'}$ */
-    /* dgsl_rot_mp_t *D_sigma_s; //!< discrete Gaussian distribution $D_{\\ZZ,σ^*}$ */
+    fmpz_t zt_bound2;  //!< @f$\lfloor q^{2(1-ξ)} \rfloor@f$, the squared zero-testing bound
+    mp_bitcnt_t zt_bound_bits; //!< bit size of @f$\lfloor q^{1-ξ} \rfloor@f$, larger coefficients are never small
+    size_t zt_nrows;   //!< number of rows in `zt_rows`, zero unless `GGHLITE_FLAGS_ZT_PRECHECK` is set
+    mp_srcptr zt_rows; //!< rows of the inverse transform times $p_{zt}$ for random coefficients, cf. @ref _fmpz_mod_poly_oz_ntt_dec_row
+    mp_ptr zt_rows_buf; //!< owns the limbs of `zt_rows` unless the params are mapped
+    gghlite_enc_t pzt; //!< zero-testing parameter $p_{zt}$, empty for mapped params where only `pzt_mpn` is set
+    gghlite_enc_t ***x; /*!< level-$k$ encodings of zero $x_{i,k,j}$, $j ∈ \\{0,1\\}$, at index `[i][k-1][j]` for
+                             each source group $G_i$ and each level $k$ selected by `rerand_mask` */
+    gghlite_enc_t *y;   //!< one level-1 encoding of 1 $y_i$ for each source group $G_i$ if `rerand_mask` is non-zero
+    dgsl_rot_mp_t *D_sigma_p; //!< discrete Gaussian distribution $D_{\\ZZ^n,σ'}$ for level-0 samples
+    dgsl_rot_mp_t *D_sigma_s; //!< discrete Gaussian distribution $D_{\\ZZ^n,σ^*}$ for re-randomisation
     fmpz_mod_poly_oz_ntt_precomp_t ntt; //!< pre-computation data for computing in the NTT domain
+    mp_limb_t *primes; //!< prime factors $p_i$ of $q$ if `GGHLITE_FLAGS_RNS` is set
+    size_t nprimes;    //!< number of prime factors of $q$ if `GGHLITE_FLAGS_RNS` is set
+    fmpz_mod_poly_oz_rns_precomp_t rns; //!< pre-computation data for computing modulo each $p_i$
+    gghlite_enc_rns_t pzt_rns;          //!< $p_{zt}$ modulo each $p_i$
+    gghlite_enc_mpn_view_t pzt_mpn;     //!< $p_{zt}$ as a contiguous block of limbs
+    gghlite_enc_mpn_t pzt_mpn_buf;      //!< owns the limbs of `pzt_mpn` unless the params are mapped
+    int nthreads;      //!< thread budget of a single operation, 0 for the OpenMP default
+    void *map;         //!< read-only mapping holding the NTT tables, `pzt_mpn` and `zt_rows`, cf. @ref gghlite_params_map
+    size_t map_size;   //!< size of `map` in bytes
 };
 
 /**
@@ -101,6 +233,8 @@ struct _gghlite_sk_struct {
 
     gghlite_enc_t *z;           //!< masking elements $z_i$
     gghlite_enc_t *z_inv;       //!< inverse of masking element $z_i$
+    gghlite_enc_t *z_inv_pow;   //!< $z^{-k}$ at index $k-1$ for $k = 1, …, κ$ if symmetric, `NULL` otherwise
+    struct _gghlite_zcache_struct *zcache; //!< cache of $\\prod_{i ∈ S} z_i^{-k}$ if asymmetric, `NULL` otherwise
     gghlite_clr_t h;            //!< masking element $h$
 
     /* gghlite_clr_t *a; //!< an element $a \\bmod \\ideal{g} = 1$ (for each $G_i$) */
@@ -122,4 +256,108 @@ struct _gghlite_sk_struct {
 
 typedef struct _gghlite_sk_struct gghlite_sk_t[1];
 
+/**
+   @brief Operations in a circuit over encodings, cf. @ref gghlite_circuit_t
+*/
+
+typedef enum {
+    GGHLITE_CIRCUIT_INPUT = 0, //!< input encoding
+    GGHLITE_CIRCUIT_ADD   = 1, //!< $a+b$
+    GGHLITE_CIRCUIT_SUB   = 2, //!< $a-b$
+    GGHLITE_CIRCUIT_MUL   = 3, //!< $a·b$
+} gghlite_circuit_op_t;
+
+/**
+   @brief Node of a circuit over encodings.
+*/
+
+struct _gghlite_circuit_node_struct {
+    gghlite_circuit_op_t op; //!< operation
+    size_t a;      //!< first operand, input index for `GGHLITE_CIRCUIT_INPUT`
+    size_t b;      //!< second operand
+    size_t depth;  //!< length of the longest path from an input
+    size_t last;   //!< depth of the last node reading this node, `SIZE_MAX` for outputs
+    size_t slot;   //!< buffer holding this node during evaluation
+    int live;      //!< this node is reachable from an output
+    int lazy;      //!< this node is computed without reducing modulo $q$
+};
+
+/**
+   @brief Circuit over encodings.
+
+   Nodes are hash-consed on creation so equal sub-expressions are represented once. Before the first
+   evaluation, nodes which do not reach an output are dropped, the remaining nodes are grouped by
+   depth and each is assigned one of `nslots` buffers such that buffers are reused as soon as their
+   last reader has been evaluated.
+*/
+
+struct _gghlite_circuit_struct {
+    size_t ninputs;   //!< number of input encodings
+    size_t nnodes;    //!< number of nodes, the first `ninputs` of which are inputs
+    size_t alloc;     //!< number of allocated nodes
+    struct _gghlite_circuit_node_struct *nodes; //!< nodes in topological order
+    size_t noutputs;  //!< number of outputs
+    size_t outputs_alloc; //!< number of allocated outputs
+    size_t *outputs;  //!< node of each output
+
+    size_t htab_size; //!< size of `htab`, a power of two
+    size_t *htab;     //!< open addressing table of nodes + 1, zero marks empty entries
+
+    int compiled;     //!< `order`, `levels`, `nslots` and node slots are up to date
+    size_t *order;    //!< live non-input nodes sorted by depth
+    size_t nlevels;   //!< number of distinct depths
+    size_t *levels;   //!< nodes of depth $d+1$ are `order[levels[d]]`, …, `order[levels[d+1]-1]`
+    size_t nslots;    //!< number of buffers required for evaluation
+};
+
+/**
+   @brief Circuit over encodings
+
+   @see _gghlite_circuit_struct
+*/
+
+typedef struct _gghlite_circuit_struct gghlite_circuit_t[1];
+
+/**
+   @brief Index entry of an encoding store, cf. @ref gghlite_store_t.
+*/
+
+typedef struct {
+    uint32_t program;  //!< program the encoding belongs to
+    uint32_t step;     //!< step within the program
+    uint32_t slot;     //!< slot within the step
+    uint32_t reserved; //!< zero
+    uint64_t record;   //!< record holding the encoding
+} gghlite_store_entry_t;
+
+/**
+   @brief Store of encodings keyed by (program, step, slot).
+
+   A store is one append-only file holding a header, $q$, fixed-size records of $n·\ell$ limbs
+   in the layout of @ref gghlite_enc_mpn_t and, once complete, the index sorted by key. A store is
+   either being written, in which case the index is kept in memory, or mapped read-only, in which
+   case records and index are used in place and pages are only read when touched.
+*/
+
+struct _gghlite_store_struct {
+    const struct _gghlite_params_struct *params; //!< params the encodings belong to
+    int fd;                 //!< file descriptor while writing, -1 once mapped
+    size_t record_size;     //!< bytes per record, a multiple of `GGHLITE_MAP_ALIGN`
+    size_t data_offset;     //!< offset of the first record
+    uint64_t nrecords;      //!< number of records
+    gghlite_store_entry_t *index; //!< index in append order while writing, sorted and in `map` once mapped
+    size_t index_alloc;     //!< number of allocated index entries while writing
+    gghlite_enc_mpn_t tmp;  //!< scratch record while writing
+    void *map;              //!< read-only mapping of the file once mapped, `NULL` while writing
+    size_t map_size;        //!< size of `map` in bytes
+};
+
+/**
+   @brief Store of encodings
+
+   @see _gghlite_store_struct
+*/
+
+typedef struct _gghlite_store_struct gghlite_store_t[1];
+
 #endif /* _DEFS_H_ */
@@ -13,6 +13,24 @@
 #include <gghlite/misc.h>
 #include <oz/oz.h>
 
+/**
+   @brief Kinds of files written by @ref gghlite_params_save, @ref gghlite_sk_save, @ref
+   gghlite_params_save_mappable and @ref gghlite_store_create, stored after `GGHLITE_FILE_MAGIC`.
+*/
+
+enum {
+    _GGHLITE_FILE_PARAMS = 0,
+    _GGHLITE_FILE_SK     = 1,
+    _GGHLITE_FILE_MAPPED = 2,
+    _GGHLITE_FILE_STORE  = 3,
+};
+
+/**
+   @brief Byte order tag stored in file headers, reads back differently on other byte orders.
+*/
+
+#define _GGHLITE_FILE_BYTE_ORDER 0x01020304
+
 /**
    @brief Check if $|g^{-1}| ≤ ℓ_g@
 */
@@ -187,12 +205,53 @@ _gghlite_params_get_q_mpfr(mpfr_t q, const gghlite_params_t self, mpfr_rnd_t rnd
     mpz_clear(qz);
 }
 
+/**
+   @brief Set `zt_bound2` and `zt_bound_bits` from $q$ and $ξ$.
+*/
+
+void _gghlite_params_set_zt_bound(gghlite_params_t self);
+
+/**
+   @brief Initialise the NTT (and RNS) pre-computation of `self` as selected by its flags.
+
+   @param phi  primitive $2n$-th root of unity to use or `NULL` to find one
+*/
+
+void _gghlite_params_init_precomp(gghlite_params_t self, const fmpz_t phi);
+
+/**
+   @brief Seed the private random number generator of `self` from `randstate`.
+*/
+
+void _gghlite_sk_seed_rng(gghlite_sk_t self, aes_randstate_t randstate);
+
 /**
    @brief Sample $z_i$ and $z_i^{-1}$.
 */
 
 void _gghlite_sk_sample_z(gghlite_sk_t self, aes_randstate_t randstate);
 
+/**
+   @brief Set $z^{-k}$ for $k = 1, …, κ$ in the symmetric case.
+*/
+
+void _gghlite_sk_set_z_inv_pow(gghlite_sk_t self);
+
+/**
+   @brief Initialise an empty cache of @f$\prod_{i ∈ S} z_i^{-k}@f$ holding at most `size` entries.
+*/
+
+void _gghlite_sk_init_zcache(gghlite_sk_t self, const size_t size);
+
+/**
+   @brief Set `rop` to @f$\prod_{i ∈ S} z_i^{-k}@f$ in the NTT domain, consulting the cache first.
+
+   On a miss the product is computed with $|S|$ multiplications and one exponentiation and replaces
+   the least recently used entry if the cache is full. Safe to call from several threads.
+*/
+
+void _gghlite_sk_get_z_inv(gghlite_enc_t rop, const gghlite_sk_t self, const gghlite_index_t S, const size_t k);
+
 void _gghlite_sk_sample_h(gghlite_sk_t self, aes_randstate_t randstate);
 
 void _gghlite_sk_sample_b(gghlite_sk_t self, aes_randstate_t randstate);
@@ -202,13 +261,13 @@ void _gghlite_sk_sample_a(gghlite_sk_t self, aes_randstate_t randstate);
 void _gghlite_sk_set_pzt(gghlite_sk_t self);
 
 /**
-   @brief Set $c = (c⋅g)/z$ for some small $c$.
+   @brief Set $x_{i,k,j} = b_{k,j}/z_i^k$ with $b_{k,j} ← D_{\\ideal{g},σ'}$ for each level $k$ in rerand_mask.
 */
 
 void _gghlite_sk_set_x(gghlite_sk_t self);
 
 /**
-   @brief Set $y = (1 + c⋅g)/z$ for some small $c$ for each source group in rerand_mask.
+   @brief Set $y_i = (1 + c⋅g)/z_i$ for some small $c$ for each source group.
 */
 
 void _gghlite_sk_set_y(gghlite_sk_t self);
@@ -315,4 +374,28 @@ double gghlite_log2_eucl_norm(const gghlite_sk_t self, const gghlite_enc_t op,
 
 void _gghlite_enc_extract_raw(gghlite_clr_t rop, const gghlite_params_t self, const gghlite_enc_t f);
 
+/**
+   @brief Compute $[p_{zt}·f]_q$ for an encoding held modulo each $p_i$.
+
+   @param rop       initialised clear text, return value
+   @param self      initialised GGHLite `params` with `GGHLITE_FLAGS_RNS` set
+   @param f         valid encoding at level-$κ$
+
+   @ingroup internal-encodings
+*/
+
+void _gghlite_enc_rns_extract_raw(gghlite_clr_t rop, const gghlite_params_t self, const gghlite_enc_rns_t f);
+
+/**
+   @brief Compute $[p_{zt}·f]_q$ for an encoding held as a contiguous block of limbs.
+
+   @param rop       initialised clear text, return value
+   @param self      initialised GGHLite `params`
+   @param f         valid encoding at level-$κ$
+
+   @ingroup internal-encodings
+*/
+
+void _gghlite_enc_mpn_extract_raw(gghlite_clr_t rop, const gghlite_params_t self, const gghlite_enc_mpn_view_t f);
+
 #endif /* _GGHLITE_INTERNALS_H_ */
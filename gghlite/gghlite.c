@@ -146,18 +146,11 @@ _gghlite_sk_set_pzt(gghlite_sk_t self)
     if (gghlite_sk_is_symmetric(self)) {
         assert(!fmpz_mod_poly_is_zero(self->z[0]));
         fmpz_mod_poly_set(z_kappa, self->z[0]);
-        fmpz_mod_poly_oz_ntt_pow_ui(z_kappa, z_kappa, self->params->kappa, self->params->n);
+        _fmpz_mod_poly_oz_ntt_pow_ui(z_kappa, z_kappa, self->params->kappa, self->params->ntt);
     } else {
-        fmpz_mod_poly_oz_ntt_set_ui(z_kappa, 1, self->params->n);
-        uint64_t t = ggh_walltime(0);
-        for(size_t i=0; i<self->params->gamma; i++) {
+        for(size_t i=0; i<self->params->gamma; i++)
             assert(!fmpz_mod_poly_is_zero(self->z[i]));
-            fmpz_mod_poly_oz_ntt_mul(z_kappa, z_kappa, self->z[i], self->params->n);
-            timer_printf("\r    Progress: [%lu / %lu] %8.2fs", i+1,
-                         self->params->gamma, ggh_seconds(ggh_walltime(t)));
-            fflush(stdout);
-        }
-        timer_printf("\n");
+        _fmpz_mod_poly_oz_ntt_mul_many(z_kappa, self->z, self->params->gamma, self->params->ntt);
     }
 
     fmpz_mod_poly_t g_inv;  fmpz_mod_poly_init(g_inv, self->params->q);
@@ -165,15 +158,44 @@ _gghlite_sk_set_pzt(gghlite_sk_t self)
     fmpz_mod_poly_oz_ntt_inv(g_inv, g_inv, self->params->n);
 
     fmpz_mod_poly_t pzt;  fmpz_mod_poly_init(pzt, self->params->q);
-    fmpz_mod_poly_oz_ntt_mul(pzt, z_kappa, g_inv, self->params->n);
+    _fmpz_mod_poly_oz_ntt_mul(pzt, z_kappa, g_inv, self->params->ntt);
 
     fmpz_mod_poly_t h;  fmpz_mod_poly_init(h, self->params->q);
     fmpz_mod_poly_oz_ntt_enc_fmpz_poly(h, self->h, self->params->ntt);
 
-    fmpz_mod_poly_oz_ntt_mul(pzt, pzt, h, self->params->n);
+    _fmpz_mod_poly_oz_ntt_mul(pzt, pzt, h, self->params->ntt);
 
     fmpz_mod_poly_init(self->params->pzt, self->params->q);
     fmpz_mod_poly_set(self->params->pzt, pzt);
+    _gghlite_params_set_zt_bound(self->params);
+
+    if (self->params->flags & GGHLITE_FLAGS_ZT_PRECHECK) {
+        const size_t n = self->params->n;
+        const mp_size_t l = self->params->ntt->mont->nlimbs;
+        fmpz_t j;
+        fmpz_init(j);
+        self->params->zt_nrows = GGHLITE_ZT_PRECHECK_NROWS;
+        self->params->zt_rows_buf = (mp_ptr)malloc(self->params->zt_nrows * n * l * sizeof(mp_limb_t));
+        if (self->params->zt_rows_buf == NULL)
+            ggh_die("failed to allocate zero-testing rows");
+        for(size_t r=0; r<self->params->zt_nrows; r++) {
+            fmpz_set_ui(j, n);
+            fmpz_randm_aes(j, self->rng, j);
+            _fmpz_mod_poly_oz_ntt_dec_row(self->params->zt_rows_buf + r*n*l, fmpz_get_ui(j), pzt,
+                                          self->params->ntt);
+        }
+        self->params->zt_rows = self->params->zt_rows_buf;
+        fmpz_clear(j);
+    }
+
+    if (self->params->flags & GGHLITE_FLAGS_RNS) {
+        gghlite_enc_rns_init(self->params->pzt_rns, self->params);
+        gghlite_enc_rns_set_gghlite_enc(self->params->pzt_rns, self->params, pzt);
+    }
+
+    gghlite_enc_mpn_init(self->params->pzt_mpn_buf, self->params);
+    gghlite_enc_mpn_set_gghlite_enc(self->params->pzt_mpn_buf, self->params, pzt);
+    *self->params->pzt_mpn = *self->params->pzt_mpn_buf->view;
 
     fmpz_mod_poly_clear(h);
     fmpz_mod_poly_clear(pzt);
@@ -181,6 +203,66 @@ _gghlite_sk_set_pzt(gghlite_sk_t self)
     fmpz_mod_poly_clear(g_inv);
 }
 
+void
+_gghlite_sk_set_y(gghlite_sk_t self)
+{
+    assert(self->params->rerand_mask);
+    assert(self->D_g);
+
+    const size_t bound = (gghlite_sk_is_symmetric(self)) ? 1 : self->params->gamma;
+    self->params->y = calloc(bound, sizeof(gghlite_enc_t));
+
+    gghlite_clr_t a;
+    gghlite_clr_init(a);
+    for(size_t i=0; i<bound; i++) {
+        /* a ← D_{1+<g>,σ'} */
+        fmpz_poly_sample_D_plus1(a, self->D_g, self->rng);
+        gghlite_enc_init(self->params->y[i], self->params);
+        fmpz_mod_poly_oz_ntt_enc_fmpz_poly(self->params->y[i], a, self->params->ntt);
+        _fmpz_mod_poly_oz_ntt_mul(self->params->y[i], self->params->y[i], self->z_inv[i], self->params->ntt);
+    }
+    gghlite_clr_clear(a);
+}
+
+void
+_gghlite_sk_set_x(gghlite_sk_t self)
+{
+    assert(self->params->rerand_mask);
+    assert(self->D_g);
+
+    const size_t bound = (gghlite_sk_is_symmetric(self)) ? 1 : self->params->gamma;
+    const size_t kappa = self->params->kappa;
+    self->params->x = calloc(bound, sizeof(gghlite_enc_t **));
+
+    gghlite_clr_t b;
+    gghlite_clr_init(b);
+    gghlite_enc_t z_inv_k;
+    gghlite_enc_init(z_inv_k, self->params);
+
+    for(size_t i=0; i<bound; i++) {
+        self->params->x[i] = calloc(kappa, sizeof(gghlite_enc_t *));
+        gghlite_enc_set(z_inv_k, self->z_inv[i]);
+        for(size_t k=0; k<kappa; k++) {
+            if (k > 0)
+                _fmpz_mod_poly_oz_ntt_mul(z_inv_k, z_inv_k, self->z_inv[i], self->params->ntt);
+            if (!gghlite_params_have_rerand(self->params, k))
+                continue;
+            self->params->x[i][k] = calloc(2, sizeof(gghlite_enc_t));
+            for(size_t j=0; j<2; j++) {
+                /* b_{k,j} ← D_{<g>,σ'} */
+                fmpz_poly_sample_D(b, self->D_g, self->rng);
+                gghlite_enc_init(self->params->x[i][k][j], self->params);
+                fmpz_mod_poly_oz_ntt_enc_fmpz_poly(self->params->x[i][k][j], b, self->params->ntt);
+                _fmpz_mod_poly_oz_ntt_mul(self->params->x[i][k][j], self->params->x[i][k][j], z_inv_k,
+                                          self->params->ntt);
+            }
+        }
+    }
+
+    gghlite_enc_clear(z_inv_k);
+    gghlite_clr_clear(b);
+}
+
 void
 _gghlite_sk_sample_h(gghlite_sk_t self, aes_randstate_t randstate)
 {
@@ -243,7 +325,6 @@ _gghlite_sk_sample_z(gghlite_sk_t self, aes_randstate_t randstate)
     for(size_t i = 0; i < bound; i++) {
         fmpz_mod_poly_oz_ntt_enc(self->z[i], self->z[i], self->params->ntt);
         fmpz_mod_poly_init(self->z_inv[i], self->params->q);
-        fmpz_mod_poly_oz_ntt_inv(self->z_inv[i], self->z[i], self->params->n);
 #pragma omp critical
         {
             progress_count_approx++;
@@ -252,6 +333,160 @@ _gghlite_sk_sample_z(gghlite_sk_t self, aes_randstate_t randstate)
         }
     }
     timer_printf("\n");
+
+    /* one inversion for all z_i */
+    _fmpz_mod_poly_oz_ntt_inv_many(self->z_inv, self->z, bound, self->params->ntt);
+
+    if (gghlite_sk_is_symmetric(self))
+        _gghlite_sk_set_z_inv_pow(self);
+    else
+        _gghlite_sk_init_zcache(self, GGHLITE_ZCACHE_SIZE);
+}
+
+void
+_gghlite_sk_set_z_inv_pow(gghlite_sk_t self)
+{
+    assert(gghlite_sk_is_symmetric(self));
+    assert(!fmpz_mod_poly_is_zero(self->z_inv[0]));
+
+    const size_t kappa = self->params->kappa;
+    self->z_inv_pow = calloc(kappa, sizeof(gghlite_enc_t));
+    fmpz_mod_poly_init(self->z_inv_pow[0], self->params->q);
+    fmpz_mod_poly_set(self->z_inv_pow[0], self->z_inv[0]);
+    for(size_t k=1; k<kappa; k++) {
+        fmpz_mod_poly_init(self->z_inv_pow[k], self->params->q);
+        _fmpz_mod_poly_oz_ntt_mul(self->z_inv_pow[k], self->z_inv_pow[k-1], self->z_inv[0], self->params->ntt);
+    }
+}
+
+void
+_gghlite_sk_init_zcache(gghlite_sk_t self, const size_t size)
+{
+    assert(!gghlite_sk_is_symmetric(self));
+    assert(size > 0);
+
+    self->zcache = malloc(sizeof(struct _gghlite_zcache_struct));
+    self->zcache->size = size;
+    self->zcache->len = 0;
+    self->zcache->clock = 0;
+    self->zcache->entries = calloc(size, sizeof(struct _gghlite_zcache_entry_struct));
+}
+
+static void
+_gghlite_sk_clear_zcache(gghlite_sk_t self)
+{
+    struct _gghlite_zcache_struct *cache = self->zcache;
+    for(size_t i=0; i<cache->len; i++) {
+        gghlite_index_clear(cache->entries[i].S);
+        fmpz_mod_poly_clear(cache->entries[i].z_inv);
+    }
+    free(cache->entries);
+    free(cache);
+    self->zcache = NULL;
+}
+
+/**
+   Return the entry for $(S,k)$ or `NULL`. Must be called inside `critical(gghlite_zcache)`.
+*/
+
+static struct _gghlite_zcache_entry_struct *
+_gghlite_zcache_find(struct _gghlite_zcache_struct *cache, const gghlite_index_t S, const size_t k)
+{
+    for(size_t i=0; i<cache->len; i++) {
+        struct _gghlite_zcache_entry_struct *e = cache->entries + i;
+        if (e->k == k && gghlite_index_equal(e->S, S)) {
+            e->used = ++cache->clock;
+            return e;
+        }
+    }
+    return NULL;
+}
+
+void
+_gghlite_sk_get_z_inv(gghlite_enc_t rop, const gghlite_sk_t self, const gghlite_index_t S, const size_t k)
+{
+    struct _gghlite_zcache_struct *cache = self->zcache;
+    const struct fmpz_mod_poly_oz_ntt_precomp_struct *ntt = self->params->ntt;
+    int hit = 0;
+
+    assert(cache);
+    assert(k > 0);
+    assert(S->gamma == self->params->gamma);
+
+#pragma omp critical(gghlite_zcache)
+    {
+        struct _gghlite_zcache_entry_struct *e = _gghlite_zcache_find(cache, S, k);
+        if (e) {
+            fmpz_mod_poly_set(rop, e->z_inv);
+            hit = 1;
+        }
+    }
+    if (hit)
+        return;
+
+    /* miss: compute outside of the lock, other threads may keep using the cache */
+    fmpz_mod_poly_oz_ntt_set_ui(rop, 1, self->params->n);
+    for(size_t i=0; i<S->gamma; i++)
+        if (gghlite_index_contains(S, i))
+            _fmpz_mod_poly_oz_ntt_mul(rop, rop, self->z_inv[i], ntt);
+    if (k > 1)
+        _fmpz_mod_poly_oz_ntt_pow_ui(rop, rop, k, ntt);
+
+#pragma omp critical(gghlite_zcache)
+    {
+        struct _gghlite_zcache_entry_struct *e = _gghlite_zcache_find(cache, S, k);
+        if (!e) {
+            if (cache->len < cache->size) {
+                e = cache->entries + cache->len++;
+                gghlite_index_init(e->S, S->gamma);
+                fmpz_mod_poly_init(e->z_inv, self->params->q);
+            } else {
+                /* evict least recently used entry */
+                e = cache->entries;
+                for(size_t i=1; i<cache->len; i++)
+                    if (cache->entries[i].used < e->used)
+                        e = cache->entries + i;
+            }
+            gghlite_index_set(e->S, S);
+            e->k = k;
+            fmpz_mod_poly_set(e->z_inv, rop);
+            e->used = ++cache->clock;
+        }
+    }
+}
+
+void
+_gghlite_sk_seed_rng(gghlite_sk_t self, aes_randstate_t randstate)
+{
+    size_t nbytes;
+    unsigned char *buf = random_aes(randstate, 128, &nbytes);
+    aes_randinit_seedn(self->rng, (char *) buf, nbytes, NULL, 0);
+    free(buf);
+}
+
+void
+_gghlite_params_init_precomp(gghlite_params_t self, const fmpz_t phi)
+{
+    assert(self->n);
+    assert(!fmpz_is_zero(self->q));
+
+    oz_flag_t ntt_flags = 0;
+    if (self->flags & GGHLITE_FLAGS_NTT_COMPACT)
+        ntt_flags |= OZ_NTT_COMPACT;
+    if (self->flags & GGHLITE_FLAGS_NTT_SEEDED)
+        ntt_flags |= OZ_NTT_COMPACT | OZ_NTT_SEEDED;
+
+    if (phi)
+        fmpz_mod_poly_oz_ntt_precomp_init_root(self->ntt, self->n, self->q, phi, ntt_flags);
+    else if (self->flags & GGHLITE_FLAGS_RNS)
+        fmpz_mod_poly_oz_ntt_precomp_init_crt_flags(self->ntt, self->n, self->primes, self->nprimes, ntt_flags);
+    else
+        fmpz_mod_poly_oz_ntt_precomp_init_flags(self->ntt, self->n, self->q, ntt_flags);
+
+    if (self->flags & GGHLITE_FLAGS_RNS)
+        fmpz_mod_poly_oz_rns_precomp_init(self->rns, self->ntt, self->primes, self->nprimes);
+    if (self->nthreads)
+        gghlite_params_set_nthreads(self, self->nthreads);
 }
 
 void
@@ -261,12 +496,7 @@ gghlite_sk_init(gghlite_sk_t self, aes_randstate_t randstate)
     assert(self->params->kappa);
     assert(self->params->gamma);
 
-    {
-        size_t nbytes;
-        unsigned char *buf = random_aes(randstate, 128, &nbytes);
-        aes_randinit_seedn(self->rng, (char *) buf, nbytes, NULL, 0);
-        free(buf);
-    }
+    _gghlite_sk_seed_rng(self, randstate);
 
     self->t_coprime = 0;
     self->t_is_prime = 0;
@@ -274,10 +504,12 @@ gghlite_sk_init(gghlite_sk_t self, aes_randstate_t randstate)
 
     self->z     = calloc(self->params->gamma, sizeof(gghlite_enc_t));
     self->z_inv = calloc(self->params->gamma, sizeof(gghlite_enc_t));
+    self->z_inv_pow = NULL;
+    self->zcache = NULL;
   
     start_timer();
     timer_printf("Starting precomp init...\n");
-    fmpz_mod_poly_oz_ntt_precomp_init(self->params->ntt, self->params->n, self->params->q);
+    _gghlite_params_init_precomp(self->params, NULL);
     timer_printf("Finished precomp init");
     print_timer();
     timer_printf("\n");
@@ -316,6 +548,18 @@ gghlite_sk_init(gghlite_sk_t self, aes_randstate_t randstate)
     timer_printf("Finished setting pzt");
     print_timer();
     timer_printf("\n");
+
+    gghlite_params_set_D_sigmas(self->params);
+
+    if (self->params->rerand_mask) {
+        start_timer();
+        timer_printf("Starting setting x and y...\n");
+        _gghlite_sk_set_y(self);
+        _gghlite_sk_set_x(self);
+        timer_printf("Finished setting x and y");
+        print_timer();
+        timer_printf("\n");
+    }
 }
 
 void
@@ -343,6 +587,15 @@ gghlite_sk_clear(gghlite_sk_t self, int clear_params)
     fmpq_poly_clear(self->g_inv);
     dgsl_rot_mp_clear(self->D_g);
 
+    if (self->z_inv_pow) {
+        for(size_t k=0; k<self->params->kappa; k++)
+            fmpz_mod_poly_clear(self->z_inv_pow[k]);
+        free(self->z_inv_pow);
+    }
+
+    if (self->zcache)
+        _gghlite_sk_clear_zcache(self);
+
     free(self->z);
     free(self->z_inv);
 
@@ -449,10 +702,176 @@ void
 _gghlite_enc_extract_raw(gghlite_clr_t rop, const gghlite_params_t self,
                          const gghlite_enc_t op)
 {
-    gghlite_enc_t t;
-    gghlite_enc_init(t, self);
-    fmpz_mod_poly_oz_ntt_mul(t, self->pzt, op, self->n);
-    fmpz_mod_poly_oz_ntt_dec(t, t, self->ntt);
-    fmpz_poly_set_fmpz_mod_poly(rop, t);
-    gghlite_enc_clear(t);
+    /* go through pzt_mpn, pzt is empty for mapped params */
+    gghlite_enc_mpn_t t;
+    gghlite_enc_mpn_init(t, self);
+    gghlite_enc_mpn_set_gghlite_enc(t, self, op);
+    _gghlite_enc_mpn_extract_raw(rop, self, t->view);
+    gghlite_enc_mpn_clear(t);
+}
+
+/**
+   Shift the $\ell$ limbs at `x` right by `shift` bits.
+*/
+
+static inline void
+_gghlite_mpn_rshift(mp_ptr x, const mp_size_t l, const mp_bitcnt_t shift)
+{
+    const mp_size_t s = shift / FLINT_BITS;
+    const unsigned int b = shift % FLINT_BITS;
+    if (s >= l) {
+        mpn_zero(x, l);
+        return;
+    }
+    if (s) {
+        mpn_copyi(x, x + s, l - s);
+        mpn_zero(x + l - s, s);
+    }
+    if (b)
+        mpn_rshift(x, x, l - s, b);
+}
+
+/**
+   Fused extraction: $t_i = p_{zt,i}·f_i$ is computed with one Montgomery multiplication per slot as
+   `pzt_mpn` is held in Montgomery representation, the inverse transform runs in place on the limb
+   array and the centred lift and shift are applied while converting each coefficient.
+*/
+
+static void
+_gghlite_enc_extract(gghlite_clr_t rop, const gghlite_params_t self, const gghlite_enc_t op,
+                     gghlite_extract_update_t update, void *ctx)
+{
+    const size_t n = self->n;
+    const mp_size_t l = self->ntt->mont->nlimbs;
+    const fmpz *q = self->q;
+    const int nthreads = _fmpz_mod_poly_oz_ntt_nthreads(self->ntt);
+
+    /* keep the top ℓ bits of the centred lift in (-q/2, q/2) */
+    const long logq = fmpz_sizeinbase(q, 2) - 1;
+    const long shift = (logq > self->ell) ? logq - self->ell : 0;
+    const size_t nbytes = (logq - shift + 1 + 7)/8;
+
+    mp_ptr a = (mp_ptr)malloc(n * l * sizeof(mp_limb_t));
+    if (a == NULL)
+        ggh_die("failed to allocate %zu limbs", n * l);
+
+#pragma omp parallel num_threads(nthreads) if(nthreads > 1)
+    {
+        mp_limb_t t[2*l];
+        mp_limb_t x[l];
+        fmpz_t tmp;
+        fmpz_init(tmp);
+#pragma omp for
+        for (size_t i = 0; i < n; i++) {
+            const fmpz *c = op->coeffs + i;
+            if (i >= (size_t)op->length || fmpz_is_zero(c)) {
+                mpn_zero(a + i*l, l);
+                continue;
+            }
+            if (fmpz_sgn(c) < 0 || fmpz_size(c) > l) {
+                fmpz_mod(tmp, c, q);
+                c = tmp;
+            }
+            _fmpz_oz_get_mpn(x, l, c);
+            _fmpz_oz_mont_mul(a + i*l, x, self->pzt_mpn->coeffs + i*l, t, self->ntt->mont);
+        }
+        fmpz_clear(tmp);
+    }
+
+    _mpn_oz_ntt_dec(a, self->ntt);
+
+    mp_limb_t q2[l];
+    _fmpz_oz_get_mpn(q2, l, q);
+    mpn_rshift(q2, q2, l, 1);
+
+    if (rop) {
+        fmpz_poly_fit_length(rop, n);
+        _fmpz_poly_set_length(rop, n);
+    }
+
+    /* bytes are passed on in blocks of 256 coefficients, in order, so hashing runs single-threaded */
+    unsigned char *buf = NULL;
+    if (update) {
+        buf = (unsigned char*)malloc(256 * nbytes);
+        if (buf == NULL)
+            ggh_die("failed to allocate %zu bytes", 256 * nbytes);
+    }
+
+#pragma omp parallel num_threads(nthreads) if(nthreads > 1 && !update)
+    {
+        mp_limb_t x[l];
+#pragma omp for
+        for (size_t i = 0; i < n; i++) {
+            mp_ptr c = a + i*l;
+            const int neg = (mpn_cmp(c, q2, l) > 0);
+            if (neg)
+                mpn_sub_n(x, self->ntt->mont->q, c, l);
+            else
+                mpn_copyi(x, c, l);
+            if (shift)
+                _gghlite_mpn_rshift(x, l, shift);
+
+            if (rop) {
+                _fmpz_oz_set_mpn(rop->coeffs + i, x, l);
+                if (neg)
+                    fmpz_neg(rop->coeffs + i, rop->coeffs + i);
+            }
+            if (update) {
+                /* two's complement, little endian, nbytes per coefficient */
+                if (neg)
+                    mpn_neg(x, x, l);
+                unsigned char *b = buf + (i % 256) * nbytes;
+                for (size_t j = 0; j < nbytes; j++)
+                    b[j] = (unsigned char)(x[j / sizeof(mp_limb_t)] >> (8 * (j % sizeof(mp_limb_t))));
+                if (i % 256 == 255 || i == n-1)
+                    update(ctx, buf, (i % 256 + 1) * nbytes);
+            }
+        }
+    }
+
+    if (rop)
+        _fmpz_poly_normalise(rop);
+    free(buf);
+    free(a);
+}
+
+void
+gghlite_enc_extract(gghlite_clr_t rop, const gghlite_params_t self, const gghlite_enc_t op)
+{
+    _gghlite_enc_extract(rop, self, op, NULL, NULL);
+}
+
+void
+gghlite_enc_extract_hash(const gghlite_params_t self, const gghlite_enc_t op,
+                         gghlite_extract_update_t update, void *ctx)
+{
+    assert(update);
+    _gghlite_enc_extract(NULL, self, op, update, ctx);
+}
+
+void
+_gghlite_enc_rns_extract_raw(gghlite_clr_t rop, const gghlite_params_t self,
+                             const gghlite_enc_rns_t op)
+{
+    gghlite_enc_rns_t t;
+    gghlite_enc_rns_init(t, self);
+    gghlite_enc_rns_mul(t, self, self->pzt_rns, op);
+    fmpz_mod_poly_oz_rns_dec_fmpz_poly(rop, t, self->rns);
+    gghlite_enc_rns_clear(t);
+}
+
+void
+_gghlite_enc_mpn_extract_raw(gghlite_clr_t rop, const gghlite_params_t self,
+                             const gghlite_enc_mpn_view_t op)
+{
+    gghlite_enc_mpn_t t;
+    gghlite_enc_t t_;
+    gghlite_enc_mpn_init(t, self);
+    gghlite_enc_init(t_, self);
+    gghlite_enc_mpn_mul(t, self, self->pzt_mpn, op);
+    fmpz_mod_poly_oz_mpn_ntt_dec(t, t->view, self->ntt);
+    fmpz_mod_poly_oz_mpn_get_fmpz_mod_poly(t_, t->view, self->ntt);
+    fmpz_poly_set_fmpz_mod_poly(rop, t_);
+    gghlite_enc_clear(t_);
+    gghlite_enc_mpn_clear(t);
 }
@@ -17,7 +17,9 @@
 #ifndef _GGHLITE_H_
 #define _GGHLITE_H_
 
+#include <assert.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <stdint.h>
 #include <math.h>
 #include <string.h>
@@ -100,6 +102,14 @@ void gghlite_sk_init(gghlite_sk_t self, aes_randstate_t randstate);
 void
 gghlite_sk_set_D_g(gghlite_sk_t self);
 
+/**
+   @brief Set up the samplers $D_{\\ZZ^n,σ'}$ and, if `rerand_mask` is non-zero, $D_{\\ZZ^n,σ^*}$.
+
+   @param params    GGHLite `params` with $σ'$ and $σ^*$ set
+
+   @ingroup params
+*/
+
 void gghlite_params_set_D_sigmas(gghlite_params_t params);
 
 /**
@@ -165,6 +175,21 @@ gghlite_jigsaw_init(gghlite_sk_t self, size_t lambda, size_t kappa,
 
 void gghlite_params_ref(gghlite_params_t rop, gghlite_sk_t op);
 
+/**
+   @brief Set the number of threads a single operation on encodings may use.
+
+   Multiplications, transforms and zero-testing split their work among up to `nthreads` threads.
+   Latency-bound callers should pass the number of available cores. Callers which process many
+   encodings in parallel themselves should pass 1 so that threads are not oversubscribed.
+
+   @param self      GGHLite `params`, the budget is kept if the pre-computation is (re-)initialised
+   @param nthreads  thread budget, 0 restores the OpenMP default
+
+   @ingroup params
+*/
+
+void gghlite_params_set_nthreads(gghlite_params_t self, int nthreads);
+
 /**
    @brief Clear GGHLite `params`.
 
@@ -271,6 +296,128 @@ static inline int gghlite_params_have_rerand(const gghlite_params_t self, const
 
 #define gghlite_clr_equal fmpz_poly_equal
 
+/**
+   @defgroup index Index Sets
+*/
+
+/**
+   @brief Initialise the empty index set over $\\{0, …, γ-1\\}$.
+
+   @ingroup index
+*/
+
+static inline void
+gghlite_index_init(gghlite_index_t S, const size_t gamma)
+{
+    S->gamma = gamma;
+    S->bits = (uint64_t *) calloc((gamma + 63)/64, sizeof(uint64_t));
+}
+
+/**
+   @brief Clear index set.
+
+   @ingroup index
+*/
+
+static inline void
+gghlite_index_clear(gghlite_index_t S)
+{
+    free(S->bits);
+}
+
+/**
+   @brief Make $S$ empty.
+
+   @ingroup index
+*/
+
+static inline void
+gghlite_index_zero(gghlite_index_t S)
+{
+    memset(S->bits, 0, (S->gamma + 63)/64 * sizeof(uint64_t));
+}
+
+/**
+   @brief Add $i$ to $S$.
+
+   @ingroup index
+*/
+
+static inline void
+gghlite_index_add(gghlite_index_t S, const size_t i)
+{
+    assert(i < S->gamma);
+    S->bits[i/64] |= ((uint64_t)1) << (i%64);
+}
+
+/**
+   @brief Return 1 if $i ∈ S$.
+
+   @ingroup index
+*/
+
+static inline int
+gghlite_index_contains(const gghlite_index_t S, const size_t i)
+{
+    assert(i < S->gamma);
+    return (S->bits[i/64] >> (i%64)) & 1;
+}
+
+/**
+   @brief Set $S = \\{i : `group[i]` ≠ 0\\}$ where `group` has length $γ$.
+
+   @ingroup index
+*/
+
+static inline void
+gghlite_index_set_group(gghlite_index_t S, const int *group)
+{
+    gghlite_index_zero(S);
+    for(size_t i=0; i<S->gamma; i++)
+        if (group[i])
+            gghlite_index_add(S, i);
+}
+
+/**
+   @brief Set $S$ to `op`, both must be initialised over the same universe.
+
+   @ingroup index
+*/
+
+static inline void
+gghlite_index_set(gghlite_index_t S, const gghlite_index_t op)
+{
+    assert(S->gamma == op->gamma);
+    memcpy(S->bits, op->bits, (S->gamma + 63)/64 * sizeof(uint64_t));
+}
+
+/**
+   @brief Return 1 if $S$ equals `op`.
+
+   @ingroup index
+*/
+
+static inline int
+gghlite_index_equal(const gghlite_index_t S, const gghlite_index_t op)
+{
+    return (S->gamma == op->gamma) && !memcmp(S->bits, op->bits, (S->gamma + 63)/64 * sizeof(uint64_t));
+}
+
+/**
+   @brief Return 1 if $S = ∅$.
+
+   @ingroup index
+*/
+
+static inline int
+gghlite_index_is_empty(const gghlite_index_t S)
+{
+    for(size_t j=0; j<(S->gamma + 63)/64; j++)
+        if (S->bits[j])
+            return 0;
+    return 1;
+}
+
 /**
    @defgroup encodings Manipulating Encodings
 */
@@ -292,11 +439,13 @@ void gghlite_enc_init(gghlite_enc_t op, const gghlite_params_t self);
 /**
    @brief Rerandomise encoding at level $k$ in group $G_i$.
 
-   Computes $f = f + ρ_0·b_{k,0} + ρ_1·b_{k,1}$ where $ρ_i ← D_{R,σ^*}$.
+   Computes $f = f + ρ_0·x_{i,k,0} + ρ_1·x_{i,k,1}$ where $ρ_j ← D_{R,σ^*}$. Both $ρ_j$ are drawn in
+   one call to the sampler and the linear combination is computed in the NTT domain.
 
-   @param f         initialised encoding at level $k$
+   @param rop       initialised encoding, return value
    @param self      initialised GGHLite `params`
-   @param k         level `1 ≤ k ≤ κ`
+   @param op        initialised encoding at level $k$
+   @param k         level `1 ≤ k ≤ κ` with re-randomisers, cf. @ref gghlite_params_have_rerand
    @param i         group index (use zero in symmetric setting)
    @param randstate entropy source, assumes `flint_randinit(randstate)` and
                     `_flint_rand_init_gmp(randstate)` was called
@@ -306,8 +455,8 @@ void gghlite_enc_init(gghlite_enc_t op, const gghlite_params_t self);
    @ingroup encodings
 */
 
-/* void gghlite_enc_rerand(gghlite_enc_t rop, const gghlite_params_t self, const gghlite_enc_t op, */
-/*                         size_t k, size_t i, aes_randstate_t randstate); */
+void gghlite_enc_rerand(gghlite_enc_t rop, const gghlite_params_t self, const gghlite_enc_t op,
+                        size_t k, size_t i, aes_randstate_t randstate);
 
 /**
    @brief Raise encoding at level $k$ to level $l$ and re-randomise if requested.
@@ -327,9 +476,9 @@ void gghlite_enc_init(gghlite_enc_t op, const gghlite_params_t self);
    @ingroup encodings
 */
 
-/* void gghlite_enc_raise(gghlite_enc_t rop, const gghlite_params_t self, const gghlite_enc_t op, */
-/*                        size_t l, size_t k, size_t i, */
-/*                        int rerand, aes_randstate_t randstate); */
+void gghlite_enc_raise(gghlite_enc_t rop, const gghlite_params_t self, const gghlite_enc_t op,
+                       size_t l, size_t k, size_t i,
+                       int rerand, aes_randstate_t randstate);
 
 /**
    @brief Raise an encoding at level $0$ to level $l$ in group $G_0$.
@@ -346,13 +495,11 @@ void gghlite_enc_init(gghlite_enc_t op, const gghlite_params_t self);
    @ingroup encodings
 */
 
-/* static inline void gghlite_enc_raise0(gghlite_enc_t rop, gghlite_params_t self, gghlite_enc_t op, */
-/*                                       size_t l, aes_randstate_t randstate) { */
-
-/*   // TODO: fix have_rerand API */
-/*   int rerand = (gghlite_params_have_rerand(self, l-1)) ? 1 : 0; */
-/*   gghlite_enc_raise(rop, self, op, l, 0, 0, rerand, randstate); */
-/* } */
+static inline void gghlite_enc_raise0(gghlite_enc_t rop, const gghlite_params_t self, const gghlite_enc_t op,
+                                      size_t l, aes_randstate_t randstate) {
+  const int rerand = (gghlite_params_have_rerand(self, l-1)) ? 1 : 0;
+  gghlite_enc_raise(rop, self, op, l, 0, 0, rerand, randstate);
+}
 
 
 /**
@@ -370,13 +517,13 @@ void gghlite_enc_init(gghlite_enc_t op, const gghlite_params_t self);
    @ingroup encodings
 */
 
-/* static inline void gghlite_enc_set_ui(gghlite_enc_t op, unsigned long c, const gghlite_params_t self, */
-/*                                       const size_t k, const size_t i, const int rerand, */
-/*                                       aes_randstate_t randstate) { */
-/*   fmpz_mod_poly_oz_ntt_set_ui(op, c, self->n); */
-/*   if(k>0) */
-/*     gghlite_enc_raise(op, self, op, k, 0, i, rerand, randstate); */
-/* } */
+static inline void gghlite_enc_set_ui(gghlite_enc_t op, unsigned long c, const gghlite_params_t self,
+                                      const size_t k, const size_t i, const int rerand,
+                                      aes_randstate_t randstate) {
+  fmpz_mod_poly_oz_ntt_set_ui(op, c, self->n);
+  if(k>0)
+    gghlite_enc_raise(op, self, op, k, 0, i, rerand, randstate);
+}
 
 /**
    @brief Set `op` to an encoding of `c` at level 0.
@@ -413,7 +560,7 @@ static inline void gghlite_enc_set_ui0(gghlite_enc_t op, unsigned long c, const
    @ingroup encodings
 */
 
-void gghlite_enc_sample(gghlite_enc_t rop, gghlite_params_t self, size_t k, size_t i, aes_randstate_t randstate);
+void gghlite_enc_sample(gghlite_enc_t rop, const gghlite_params_t self, size_t k, size_t i, aes_randstate_t randstate);
 
 /**
    @brief Encode $f$ at level-$k$ in group $G_i$.
@@ -427,7 +574,8 @@ void gghlite_enc_sample(gghlite_enc_t rop, gghlite_params_t self, size_t k, size
    @param randstate entropy source, assumes `flint_randinit(randstate)` and
                     `_flint_rand_init_gmp(randstate)` was called
 
-   @note If `self` is an asymmetric map only, then $k ≤ 1$ is required.
+   @note If `self` is an asymmetric map, the encoding is divided by $z_i^k$ for each $i$ with
+   `group[i]` set, cf. @ref gghlite_enc_set_gghlite_clr_index.
 
    @ingroup encodings
 */
@@ -438,13 +586,33 @@ gghlite_enc_set_gghlite_clr(gghlite_enc_t rop, const gghlite_sk_t self,
                             const int rerand);
 
 /**
-   @brief Encode $f$ at level-$0$.
+   @brief Encode $f$ at level-$k$ in the index set $S$.
+
+   In the asymmetric case the encoding is divided by @f$\prod_{i ∈ S} z_i^k@f$. These products are
+   kept in a bounded least-recently-used cache on `self`, so encoding into a previously seen index
+   set at the same level costs one multiplication. In the symmetric case $S$ is ignored.
 
    @param rop       initialised encoding, return value
    @param self      initialised GGHLite instance
    @param f         an element in $\\ZZ[x]/(x^n+1)$
+   @param k         target level $k ≥ 0$
+   @param S         index set over $\\{0, …, γ-1\\}$
+   @param rerand    flag controlling if re-randomisation is run
+
+   @ingroup encodings
+*/
 
-   @note If `self` is an asymmetric map only, then $k ≤ 1$ is required.
+void
+gghlite_enc_set_gghlite_clr_index(gghlite_enc_t rop, const gghlite_sk_t self,
+                                  const gghlite_clr_t f, const size_t k, const gghlite_index_t S,
+                                  const int rerand);
+
+/**
+   @brief Encode $f$ at level-$0$.
+
+   @param rop       initialised encoding, return value
+   @param self      initialised GGHLite instance
+   @param f         an element in $\\ZZ[x]/(x^n+1)$
 
    @ingroup encodings
 */
@@ -473,7 +641,7 @@ static inline void
 gghlite_enc_mul(gghlite_enc_t h, const gghlite_params_t self,
                 const gghlite_enc_t f, const gghlite_enc_t g)
 {
-    fmpz_mod_poly_oz_ntt_mul(h, f, g, self->n);
+    _fmpz_mod_poly_oz_ntt_mul(h, f, g, self->ntt);
 }
 
 /**
@@ -514,9 +682,116 @@ gghlite_enc_sub(gghlite_enc_t h, const gghlite_params_t self,
     fmpz_mod_poly_sub(h, f, g);
 }
 
+/**
+   @brief Compute $h = h + f·g$.
+
+   The product is reduced modulo $q$ together with the sum, i.e. only once.
+
+   @param h         valid encoding, return value
+   @param self      initialised GGHLite `params`
+   @param f         valid encoding
+   @param g         valid encoding
+
+   @ingroup encodings
+*/
+
+static inline void
+gghlite_enc_addmul(gghlite_enc_t h, const gghlite_params_t self,
+                   const gghlite_enc_t f, const gghlite_enc_t g)
+{
+    _fmpz_mod_poly_oz_ntt_addmul(h, f, g, self->ntt);
+}
+
+/**
+   @brief Compute $h = \\sum_{i<\\mbox{len}} f_i·g_i$.
+
+   Products are accumulated without reduction and reduced modulo $q$ once per slot at the end.
+
+   @param h         initialised encoding, return value, may alias any input
+   @param self      initialised GGHLite `params`
+   @param f         array of `len` valid encodings
+   @param g         array of `len` valid encodings
+   @param len       number of terms
+
+   @ingroup encodings
+*/
+
+static inline void
+gghlite_enc_dot(gghlite_enc_t h, const gghlite_params_t self,
+                gghlite_enc_t *f, gghlite_enc_t *g, const size_t len)
+{
+    _fmpz_mod_poly_oz_ntt_dot(h, f, g, len, self->ntt);
+}
+
+/**
+   @brief Compute $h = \\prod_{i<\\mbox{count}} e_i$.
+
+   Faster than repeated calls to @ref gghlite_enc_mul as every coefficient of the product is
+   accumulated in Montgomery representation and coefficients are distributed among threads.
+
+   @param rop       initialised encoding, return value, may alias any input
+   @param self      initialised GGHLite `params`
+   @param encs      array of `count` valid encodings
+   @param count     number of encodings, `rop` is set to one if zero
+
+   @ingroup encodings
+*/
+
+static inline void
+gghlite_enc_mul_many(gghlite_enc_t rop, const gghlite_params_t self,
+                     gghlite_enc_t *encs, const size_t count)
+{
+    _fmpz_mod_poly_oz_ntt_mul_many(rop, encs, count, self->ntt);
+}
+
+/**
+   @brief Compute $h = f+g$ without reducing modulo $q$.
+
+   The result may only be passed to @ref gghlite_enc_mul, @ref gghlite_enc_addmul,
+   @ref gghlite_enc_dot, @ref gghlite_enc_is_zero or further lazy additions and subtractions, all
+   of which accept coefficients in $[0, kq)$. This saves the comparison with $q$ in chains of additions
+   before a multiplication.
+
+   @param h         initialised encoding, return value
+   @param self      initialised GGHLite `params`
+   @param f         valid or lazily reduced encoding
+   @param g         valid or lazily reduced encoding
+
+   @ingroup encodings
+*/
+
+static inline void
+gghlite_enc_add_lazy(gghlite_enc_t h, const gghlite_params_t self,
+                     const gghlite_enc_t f, const gghlite_enc_t g)
+{
+    _fmpz_mod_poly_oz_ntt_add_lazy(h, f, g, self->ntt);
+}
+
+/**
+   @brief Compute $h = f-g$ without reducing modulo $q$.
+
+   @see gghlite_enc_add_lazy
+
+   @ingroup encodings
+*/
+
+static inline void
+gghlite_enc_sub_lazy(gghlite_enc_t h, const gghlite_params_t self,
+                     const gghlite_enc_t f, const gghlite_enc_t g)
+{
+    _fmpz_mod_poly_oz_ntt_sub_lazy(h, f, g, self->ntt);
+}
+
 /**
    @brief Return 1 if $f$ is an encoding of zero at level $κ$
 
+   The extracted coefficients are compared against the bound pre-computed in `params` and the test
+   stops at the first coefficient which shows that $f$ does not encode zero.
+
+   If `GGHLITE_FLAGS_ZT_PRECHECK` is set, `GGHLITE_ZT_PRECHECK_NROWS` random coefficients are
+   computed directly in $O(n)$ first. As encodings of non-zero elements have all coefficients close
+   to uniform modulo $q$, the full inverse transform then only runs for likely encodings of zero.
+
    @param self      initialised GGHLite `params`
    @param f         valid encoding at level-$k$
 
@@ -526,6 +801,822 @@ gghlite_enc_sub(gghlite_enc_t h, const gghlite_params_t self,
 int
 gghlite_enc_is_zero(const gghlite_params_t self, const gghlite_enc_t op);
 
+/**
+   @brief Return 1 if $f$ and $g$ encode the same element at level $κ$.
+
+   Equivalent to @ref gghlite_enc_is_zero on $f-g$ but the difference is formed slot by slot while
+   multiplying by $p_{zt}$ instead of as a separate encoding.
+
+   @param self      initialised GGHLite `params`
+   @param f         valid encoding at level-$κ$
+   @param g         valid encoding at level-$κ$
+
+   @ingroup encodings
+*/
+
+int
+gghlite_enc_equal(const gghlite_params_t self, const gghlite_enc_t f, const gghlite_enc_t g);
+
+/**
+   @brief Set `rop[i]` to @ref gghlite_enc_is_zero of `ops[i]` for all $i < \\mbox{len}$.
+
+   The tests are independent and distributed among up to `params->nthreads` threads, each running
+   its tests single-threaded in one scratch buffer.
+
+   @param rop       array of `len` integers, return value
+   @param self      initialised GGHLite `params`
+   @param ops       array of `len` valid encodings at level-$κ$
+   @param len       number of encodings
+
+   @ingroup encodings
+*/
+
+void
+gghlite_enc_is_zero_batch(int *rop, const gghlite_params_t self, gghlite_enc_t *ops, const size_t len);
+
+/**
+   @brief Extract a canonical string from $f$.
+
+   Sets $\\mbox{rop}_i$ to the $ℓ$ most significant bits (`params->ell`) of the $i$-th coefficient
+   of @f$[p_{zt}·f]_q@f$ lifted to @f$(-q/2, q/2)@f$, i.e. the coefficient divided by
+   @f$2^{\lfloor\log_2 q\rfloor - ℓ}@f$ and rounded towards zero. The product with $p_{zt}$, the
+   inverse transform, the lift and the shift are computed in one pass over a limb array.
+
+   @param rop       initialised clear text, return value
+   @param self      initialised GGHLite `params`
+   @param f         valid encoding at level-$κ$
+
+   @ingroup encodings
+*/
+
+void
+gghlite_enc_extract(gghlite_clr_t rop, const gghlite_params_t self, const gghlite_enc_t f);
+
+/**
+   @brief Callback receiving the output of @ref gghlite_enc_extract_hash, e.g. the update function
+   of a hash.
+*/
+
+typedef void (*gghlite_extract_update_t)(void *ctx, const unsigned char *buf, size_t len);
+
+/**
+   @brief Feed the string extracted from $f$ to `update` instead of storing it.
+
+   Each coefficient computed as in @ref gghlite_enc_extract is written as a two's complement integer
+   in @f$\lceil (\lfloor\log_2 q\rfloor - s + 1)/8 \rceil@f$ bytes, little endian, where $s$ is the
+   shift applied, and the bytes are passed to `update` in order, in blocks of up to 256
+   coefficients. This allows deriving keys without materialising the extracted polynomial.
+
+   @param self      initialised GGHLite `params`
+   @param f         valid encoding at level-$κ$
+   @param update    called with `ctx` and each block of bytes
+   @param ctx       passed through to `update`
+
+   @ingroup encodings
+*/
+
+void
+gghlite_enc_extract_hash(const gghlite_params_t self, const gghlite_enc_t f,
+                         gghlite_extract_update_t update, void *ctx);
+
+/**
+   @defgroup rns Encodings modulo word-sized primes
+
+   If `GGHLITE_FLAGS_RNS` is set, $q$ is a product of word-sized primes $p_i$ and encodings may be
+   converted to residues modulo each $p_i$. Arithmetic on such encodings does not call into GMP.
+*/
+
+/**
+   @brief Return true if params were generated with `GGHLITE_FLAGS_RNS`.
+
+   @param self      initialised GGHLite `params`
+
+   @ingroup rns
+*/
+
+static inline int gghlite_params_is_rns(const gghlite_params_t self) {
+  return (self->flags & GGHLITE_FLAGS_RNS) ? 1 : 0;
+}
+
+/**
+   @brief Initialise encoding to zero.
+
+   @param op   uninitialised encoding
+   @param self initialised GGHLite `params` with `GGHLITE_FLAGS_RNS` set
+
+   @ingroup rns
+*/
+
+void gghlite_enc_rns_init(gghlite_enc_rns_t op, const gghlite_params_t self);
+
+#define gghlite_enc_rns_clear fmpz_mod_poly_oz_rns_clear
+
+/**
+   @brief Set `rop` to `op` modulo each $p_i$.
+
+   @ingroup rns
+*/
+
+static inline void
+gghlite_enc_rns_set_gghlite_enc(gghlite_enc_rns_t rop, const gghlite_params_t self,
+                                const gghlite_enc_t op)
+{
+    fmpz_mod_poly_oz_rns_set_fmpz_mod_poly(rop, op, self->rns);
+}
+
+/**
+   @brief Set `rop` to the encoding modulo $q$ represented by `op`.
+
+   @ingroup rns
+*/
+
+static inline void
+gghlite_enc_set_gghlite_enc_rns(gghlite_enc_t rop, const gghlite_params_t self,
+                                const gghlite_enc_rns_t op)
+{
+    fmpz_mod_poly_oz_rns_get_fmpz_mod_poly(rop, op, self->rns);
+}
+
+/**
+   @brief Compute $h = f·g$.
+
+   @ingroup rns
+*/
+
+static inline void
+gghlite_enc_rns_mul(gghlite_enc_rns_t h, const gghlite_params_t self,
+                    const gghlite_enc_rns_t f, const gghlite_enc_rns_t g)
+{
+    fmpz_mod_poly_oz_rns_mul(h, f, g, self->rns);
+}
+
+/**
+   @brief Compute $h = f+g$.
+
+   @ingroup rns
+*/
+
+static inline void
+gghlite_enc_rns_add(gghlite_enc_rns_t h, const gghlite_params_t self,
+                    const gghlite_enc_rns_t f, const gghlite_enc_rns_t g)
+{
+    fmpz_mod_poly_oz_rns_add(h, f, g, self->rns);
+}
+
+/**
+   @brief Compute $h = f-g$.
+
+   @ingroup rns
+*/
+
+static inline void
+gghlite_enc_rns_sub(gghlite_enc_rns_t h, const gghlite_params_t self,
+                    const gghlite_enc_rns_t f, const gghlite_enc_rns_t g)
+{
+    fmpz_mod_poly_oz_rns_sub(h, f, g, self->rns);
+}
+
+/**
+   @brief Return 1 if $f$ is an encoding of zero at level $κ$
+
+   The inverse transform is computed modulo each $p_i$, we only lift to $\ZZ_q$ at the very end.
+
+   @param self      initialised GGHLite `params` with `GGHLITE_FLAGS_RNS` set
+   @param op        valid encoding at level-$κ$
+
+   @ingroup rns
+*/
+
+int
+gghlite_enc_rns_is_zero(const gghlite_params_t self, const gghlite_enc_rns_t op);
+
+/**
+   @defgroup mpn Encodings as contiguous limb arrays
+
+   Encodings may be converted to @ref gghlite_enc_mpn_t which stores all $n$ coefficients in one
+   aligned block of limbs. Arithmetic on such encodings performs neither divisions nor allocations.
+   Inputs are read-only views @ref gghlite_enc_mpn_view_t, pass `op->view` for an owned encoding `op`.
+*/
+
+/**
+   @brief Initialise encoding to zero.
+
+   @param op   uninitialised encoding
+   @param self initialised GGHLite `params`
+
+   @ingroup mpn
+*/
+
+static inline void
+gghlite_enc_mpn_init(gghlite_enc_mpn_t op, const gghlite_params_t self)
+{
+    fmpz_mod_poly_oz_mpn_init(op, self->ntt);
+}
+
+#define gghlite_enc_mpn_clear fmpz_mod_poly_oz_mpn_clear
+
+/**
+   @brief Set `rop` to `op`.
+
+   @ingroup mpn
+*/
+
+#define gghlite_enc_mpn_set fmpz_mod_poly_oz_mpn_set
+
+/**
+   @brief Set `rop` to `op` as a contiguous block of limbs.
+
+   @ingroup mpn
+*/
+
+static inline void
+gghlite_enc_mpn_set_gghlite_enc(gghlite_enc_mpn_t rop, const gghlite_params_t self,
+                                const gghlite_enc_t op)
+{
+    fmpz_mod_poly_oz_mpn_set_fmpz_mod_poly(rop, op, self->ntt);
+}
+
+/**
+   @brief Set `rop` to `op`.
+
+   @ingroup mpn
+*/
+
+static inline void
+gghlite_enc_set_gghlite_enc_mpn(gghlite_enc_t rop, const gghlite_params_t self,
+                                const gghlite_enc_mpn_view_t op)
+{
+    fmpz_mod_poly_oz_mpn_get_fmpz_mod_poly(rop, op, self->ntt);
+}
+
+/**
+   @brief Compute $h = f·g$.
+
+   @ingroup mpn
+*/
+
+static inline void
+gghlite_enc_mpn_mul(gghlite_enc_mpn_t h, const gghlite_params_t self,
+                    const gghlite_enc_mpn_view_t f, const gghlite_enc_mpn_view_t g)
+{
+    fmpz_mod_poly_oz_mpn_mul(h, f, g, self->ntt);
+}
+
+/**
+   @brief Compute $h = f+g$.
+
+   @ingroup mpn
+*/
+
+static inline void
+gghlite_enc_mpn_add(gghlite_enc_mpn_t h, const gghlite_params_t self,
+                    const gghlite_enc_mpn_view_t f, const gghlite_enc_mpn_view_t g)
+{
+    fmpz_mod_poly_oz_mpn_add(h, f, g, self->ntt);
+}
+
+/**
+   @brief Compute $h = f-g$.
+
+   @ingroup mpn
+*/
+
+static inline void
+gghlite_enc_mpn_sub(gghlite_enc_mpn_t h, const gghlite_params_t self,
+                    const gghlite_enc_mpn_view_t f, const gghlite_enc_mpn_view_t g)
+{
+    fmpz_mod_poly_oz_mpn_sub(h, f, g, self->ntt);
+}
+
+/**
+   @brief Return 1 if $f$ is an encoding of zero at level $κ$
+
+   The product with $p_{zt}$, the inverse transform and the bound check run on limb arrays without
+   converting coefficients to `fmpz`.
+
+   @param self      initialised GGHLite `params`
+   @param op        valid encoding at level-$κ$
+
+   @ingroup mpn
+*/
+
+int
+gghlite_enc_mpn_is_zero(const gghlite_params_t self, const gghlite_enc_mpn_view_t op);
+
+/**
+   @defgroup mat Matrices of encodings
+*/
+
+/**
+   @brief Initialise a matrix of encodings of zero.
+
+   @param m         uninitialised matrix
+   @param self      initialised GGHLite `params`
+   @param nrows     number of rows
+   @param ncols     number of columns
+
+   @ingroup mat
+*/
+
+void gghlite_enc_mat_init(gghlite_enc_mat_t m, const gghlite_params_t self, const size_t nrows, const size_t ncols);
+
+/**
+   @brief Clear matrix.
+
+   @ingroup mat
+*/
+
+void gghlite_enc_mat_clear(gghlite_enc_mat_t m);
+
+/**
+   @brief Return entry $(i,j)$ of `m`.
+
+   @ingroup mat
+*/
+
+static inline fmpz_mod_poly_struct *
+gghlite_enc_mat_entry(const gghlite_enc_mat_t m, const size_t i, const size_t j)
+{
+    assert(i < m->nrows && j < m->ncols);
+    return m->entries[i*m->ncols + j];
+}
+
+/**
+   @brief Swap two matrices.
+
+   @ingroup mat
+*/
+
+static inline void
+gghlite_enc_mat_swap(gghlite_enc_mat_t a, gghlite_enc_mat_t b)
+{
+    struct _gghlite_enc_mat_struct t = *a;
+    *a = *b;
+    *b = t;
+}
+
+/**
+   @brief Set `rop` to a copy of `op`, both must have the same dimensions.
+
+   @ingroup mat
+*/
+
+void gghlite_enc_mat_set(gghlite_enc_mat_t rop, const gghlite_enc_mat_t op);
+
+/**
+   @brief Compute $C = A·B$.
+
+   Each entry is a dot product of a row of $A$ and a column of $B$ which is accumulated in the NTT
+   domain without reduction and reduced modulo $q$ once per slot, cf. @ref gghlite_enc_dot. The
+   entries of $C$ are split into tiles of `GGHLITE_ENC_MAT_BLOCK` rows and columns which are
+   distributed among up to `params->nthreads` threads, each computing its tiles single-threaded. A
+   product with a single tile runs the kernels on all threads instead.
+
+   @param rop       initialised matrix with the rows of `a` and the columns of `b`, may alias `a` or `b`
+   @param self      initialised GGHLite `params`
+   @param a         valid matrix
+   @param b         valid matrix with as many rows as `a` has columns
+
+   @ingroup mat
+*/
+
+void gghlite_enc_mat_mul(gghlite_enc_mat_t rop, const gghlite_params_t self,
+                         const gghlite_enc_mat_t a, const gghlite_enc_mat_t b);
+
+/**
+   @brief Compute $w = A·v$.
+
+   @param rop       array of `a->nrows` initialised encodings, may alias `v`
+   @param self      initialised GGHLite `params`
+   @param a         valid matrix
+   @param v         array of `a->ncols` valid encodings
+
+   @ingroup mat
+*/
+
+void gghlite_enc_mat_mul_vec(gghlite_enc_t *rop, const gghlite_params_t self,
+                             const gghlite_enc_mat_t a, gghlite_enc_t *v);
+
+/**
+   @brief Compute $C = \prod_{i<\mbox{count}} A_i$.
+
+   The product is accumulated from the left if $A_0$ has at most as many rows as $A_{count-1}$ has
+   columns and from the right otherwise. Hence, a chain bracketed by a row vector and a column vector,
+   as in matrix branching programs, only computes vector-matrix products.
+
+   @param rop       initialised matrix with the rows of $A_0$ and the columns of $A_{count-1}$
+   @param self      initialised GGHLite `params`
+   @param mats      array of `count` valid matrices with matching dimensions
+   @param count     number of matrices, at least one
+
+   @ingroup mat
+*/
+
+void gghlite_enc_mat_mul_many(gghlite_enc_mat_t rop, const gghlite_params_t self,
+                              gghlite_enc_mat_t *mats, const size_t count);
+
+/**
+   @defgroup circuits Circuits over encodings
+*/
+
+/**
+   @brief Initialise an empty circuit on `ninputs` inputs.
+
+   The inputs are the nodes $0, …, \mbox{ninputs}-1$.
+
+   @param self      uninitialised circuit
+   @param ninputs   number of input encodings
+
+   @ingroup circuits
+*/
+
+void gghlite_circuit_init(gghlite_circuit_t self, const size_t ninputs);
+
+/**
+   @brief Clear circuit.
+
+   @ingroup circuits
+*/
+
+void gghlite_circuit_clear(gghlite_circuit_t self);
+
+/**
+   @brief Return the node of the $i$-th input.
+
+   @ingroup circuits
+*/
+
+static inline size_t
+gghlite_circuit_input(const gghlite_circuit_t self, const size_t i)
+{
+    assert(i < self->ninputs);
+    return i;
+}
+
+/**
+   @brief Return a node computing `op` on the nodes $a$ and $b$.
+
+   If an equal node exists it is returned instead of creating a new one. Operands of additions and
+   multiplications are ordered first, so $a+b$ and $b+a$ yield the same node.
+
+   @param self      initialised circuit
+   @param op        one of `GGHLITE_CIRCUIT_ADD`, `GGHLITE_CIRCUIT_SUB` or `GGHLITE_CIRCUIT_MUL`
+   @param a         node
+   @param b         node
+
+   @ingroup circuits
+*/
+
+size_t gghlite_circuit_node(gghlite_circuit_t self, const gghlite_circuit_op_t op, size_t a, size_t b);
+
+/**
+   @brief Return a node computing $a+b$.
+
+   @ingroup circuits
+*/
+
+static inline size_t
+gghlite_circuit_add(gghlite_circuit_t self, const size_t a, const size_t b)
+{
+    return gghlite_circuit_node(self, GGHLITE_CIRCUIT_ADD, a, b);
+}
+
+/**
+   @brief Return a node computing $a-b$.
+
+   @ingroup circuits
+*/
+
+static inline size_t
+gghlite_circuit_sub(gghlite_circuit_t self, const size_t a, const size_t b)
+{
+    return gghlite_circuit_node(self, GGHLITE_CIRCUIT_SUB, a, b);
+}
+
+/**
+   @brief Return a node computing $a·b$.
+
+   @ingroup circuits
+*/
+
+static inline size_t
+gghlite_circuit_mul(gghlite_circuit_t self, const size_t a, const size_t b)
+{
+    return gghlite_circuit_node(self, GGHLITE_CIRCUIT_MUL, a, b);
+}
+
+/**
+   @brief Declare node $a$ an output and return the index of this output.
+
+   @ingroup circuits
+*/
+
+size_t gghlite_circuit_output(gghlite_circuit_t self, const size_t a);
+
+/**
+   @brief Evaluate circuit on encodings.
+
+   All nodes are evaluated in the NTT domain. Nodes of the same depth are independent and are
+   distributed among up to `params->nthreads` threads; a depth holding a single node runs its kernel
+   on all threads instead. Additions and subtractions only read by multiplications or other such
+   additions are not reduced modulo $q$. Intermediate results share `self->nslots` buffers.
+
+   The schedule is computed on the first call after nodes or outputs were added, hence `self` must
+   not be evaluated concurrently by several threads unless it was evaluated once before.
+
+   @param rop       array of `self->noutputs` initialised encodings, return value
+   @param params    initialised GGHLite `params`
+   @param self      initialised circuit
+   @param inputs    array of `self->ninputs` valid encodings
+
+   @ingroup circuits
+*/
+
+void gghlite_circuit_eval(gghlite_enc_t *rop, const gghlite_params_t params, gghlite_circuit_t self,
+                          gghlite_enc_t *inputs);
+
+/**
+   @brief Evaluate circuit on encodings and zero-test all outputs.
+
+   Sets `rop[j]` to 1 if the $j$-th output encodes zero at level $κ$, cf.
+   @ref gghlite_enc_is_zero_batch.
+
+   @param rop       array of `self->noutputs` integers, return value
+   @param params    initialised GGHLite `params`
+   @param self      initialised circuit
+   @param inputs    array of `self->ninputs` valid encodings
+
+   @ingroup circuits
+*/
+
+void gghlite_circuit_eval_is_zero(int *rop, const gghlite_params_t params, gghlite_circuit_t self,
+                                  gghlite_enc_t *inputs);
+
+/**
+   @defgroup io Saving and loading
+*/
+
+/**
+   @brief Write public parameters to `fh`.
+
+   Integers and encodings are written as raw limbs, so files can only be read back on machines with
+   the same limb size and byte order.
+
+   @param self  initialised GGHLite `params`
+   @param fh    file opened for writing in binary mode
+
+   @ingroup io
+*/
+
+void gghlite_params_save(const gghlite_params_t self, FILE *fh);
+
+/**
+   @brief Read public parameters from `fh`.
+
+   Accepts files written by @ref gghlite_params_save and by @ref gghlite_sk_save, of which only the
+   public part is read. The NTT pre-computation is rebuilt from its stored root of unity, other
+   derived data from the stored values. The thread budget is not stored, cf. @ref
+   gghlite_params_set_nthreads.
+
+   @param self  uninitialised GGHLite `params`
+   @param fh    file opened for reading in binary mode
+
+   @ingroup io
+*/
+
+void gghlite_params_load(gghlite_params_t self, FILE *fh);
+
+/**
+   @brief Write GGHLite instance to `fh`.
+
+   Writes the public parameters followed by $g$, $g^{-1}$, $h$, $z_i$, $z_i^{-1}$ and the state of
+   the sampler $D_{\\ideal{g},σ'}$.
+
+   @warning The file contains the secret key.
+
+   @param self  initialised GGHLite instance
+   @param fh    file opened for writing in binary mode
+
+   @ingroup io
+*/
+
+void gghlite_sk_save(const gghlite_sk_t self, FILE *fh);
+
+/**
+   @brief Read GGHLite instance from `fh`.
+
+   Loading skips all sampling, inversions and root finding of @ref gghlite_sk_init; the instance
+   behaves like the saved one.
+
+   @param self       uninitialised GGHLite instance
+   @param fh         file written by @ref gghlite_sk_save, opened for reading in binary mode
+   @param randstate  entropy source, seeds the private randomness of `self`
+
+   @ingroup io
+*/
+
+void gghlite_sk_load(gghlite_sk_t self, FILE *fh, aes_randstate_t randstate);
+
+/**
+   @brief Write public parameters to `fh` in a layout which @ref gghlite_params_map uses in place.
+
+   The NTT twiddle tables, $p_{zt}$ in Montgomery representation and the zero-testing rows are
+   written as limb arrays aligned to `GGHLITE_MAP_ALIGN` bytes. Re-randomisers are not written.
+
+   @param self  initialised GGHLite `params`
+   @param fh    seekable file opened for writing in binary mode, positioned at its start
+
+   @ingroup io
+*/
+
+void gghlite_params_save_mappable(const gghlite_params_t self, FILE *fh);
+
+/**
+   @brief Map public parameters written by @ref gghlite_params_save_mappable read-only.
+
+   The NTT, multiplication and zero-testing kernels read the twiddle tables, `pzt_mpn` and
+   `zt_rows` directly from the mapping, i.e. processes mapping the same file share one copy of them
+   in the page cache and setting up takes time independent of $n$ apart from building the sampler
+   $D_{\ZZ^n,σ'}$ and, if `GGHLITE_FLAGS_RNS` is set, $p_{zt}$ modulo each $p_i$. The mapping is
+   released by @ref gghlite_params_clear.
+
+   @note Mapped parameters have no re-randomisers, `rerand_mask` is zero and `pzt` is empty.
+
+   @param self      uninitialised GGHLite `params`
+   @param filename  file written by @ref gghlite_params_save_mappable, must not be modified while mapped
+
+   @ingroup io
+*/
+
+void gghlite_params_map(gghlite_params_t self, const char *filename);
+
+/**
+   @brief Return the size in bytes of a packed encoding, i.e. $\lceil n·\lceil \log_2 q \rceil / 8 \rceil$.
+
+   @ingroup io
+*/
+
+size_t gghlite_enc_packed_size(const gghlite_params_t self);
+
+/**
+   @brief Return the size in bytes of `count` packed coefficients, cf. @ref gghlite_enc_pack_range.
+
+   @ingroup io
+*/
+
+size_t gghlite_enc_packed_size_range(const gghlite_params_t self, const size_t count);
+
+/**
+   @brief Write `op` to `buf` in the packed format.
+
+   Each of the $n$ coefficients in the NTT domain takes exactly $\lceil \log_2 q \rceil$ bits of a
+   little-endian bit stream which is padded with zero bits to a whole byte. The format does not
+   depend on the limb size or byte order of the machine.
+
+   @param buf   buffer of @ref gghlite_enc_packed_size bytes
+   @param self  initialised GGHLite `params`
+   @param op    encoding, coefficients outside $[0,q)$ are reduced first
+
+   @ingroup io
+*/
+
+void gghlite_enc_pack(uint8_t *buf, const gghlite_params_t self, const gghlite_enc_t op);
+
+/**
+   @brief Read `rop` from `buf` in the packed format, cf. @ref gghlite_enc_pack.
+
+   Aborts if a coefficient is not reduced modulo $q$ or the padding is not zero, i.e. only the
+   canonical packing of an encoding is accepted.
+
+   @ingroup io
+*/
+
+void gghlite_enc_unpack(gghlite_enc_t rop, const gghlite_params_t self, const uint8_t *buf);
+
+/**
+   @brief Write coefficients `start … start+count-1` of `op` to `buf` in the packed format.
+
+   Eight coefficients take exactly $\lceil \log_2 q \rceil$ bytes, hence `start` must be a
+   multiple of 8 and so must `count` unless the range ends at $n$. The bytes written are those at
+   offset $\mbox{start}·\lceil \log_2 q \rceil/8$ of @ref gghlite_enc_pack, i.e. concatenating the
+   ranges of a partition of $[0,n)$ in order gives the full packing.
+
+   @param buf   buffer of @ref gghlite_enc_packed_size_range bytes for `count`
+
+   @ingroup io
+*/
+
+void gghlite_enc_pack_range(uint8_t *buf, const gghlite_params_t self, const gghlite_enc_t op,
+                            const size_t start, const size_t count);
+
+/**
+   @brief Read coefficients `start … start+count-1` of `rop` from `buf`, cf. @ref
+   gghlite_enc_pack_range.
+
+   Other coefficients of `rop` are left unchanged, i.e. an encoding is read by unpacking the ranges
+   of a partition of $[0,n)$ into an encoding set to zero.
+
+   @ingroup io
+*/
+
+void gghlite_enc_unpack_range(gghlite_enc_t rop, const gghlite_params_t self, const uint8_t *buf,
+                              const size_t start, const size_t count);
+
+/**
+   @brief Write `op` to `fd` in the packed format, `GGHLITE_PACK_CHUNK` coefficients at a time.
+
+   @ingroup io
+*/
+
+void gghlite_enc_pack_fd(int fd, const gghlite_params_t self, const gghlite_enc_t op);
+
+/**
+   @brief Read `rop` from `fd` in the packed format, `GGHLITE_PACK_CHUNK` coefficients at a time.
+
+   Reads exactly @ref gghlite_enc_packed_size bytes, aborts if the stream ends early.
+
+   @ingroup io
+*/
+
+void gghlite_enc_unpack_fd(gghlite_enc_t rop, const gghlite_params_t self, int fd);
+
+/**
+   @defgroup store Stores of encodings
+*/
+
+/**
+   @brief Create an empty store at `filename` for encodings under `params`.
+
+   Encodings are added with @ref gghlite_store_append, the store is completed by @ref
+   gghlite_store_clear after which it can be mapped by @ref gghlite_store_open.
+
+   @param self      uninitialised store
+   @param params    initialised GGHLite `params`, must outlive `self`
+   @param filename  file to create, truncated if it exists
+
+   @ingroup store
+*/
+
+void gghlite_store_create(gghlite_store_t self, const gghlite_params_t params, const char *filename);
+
+/**
+   @brief Append `op` under the key (`program`, `step`, `slot`).
+
+   The encoding is written as one record in Montgomery representation, only the index entry is
+   kept in memory. Keys must be distinct, which is checked by @ref gghlite_store_clear.
+
+   @param self  store created by @ref gghlite_store_create
+
+   @ingroup store
+*/
+
+void gghlite_store_append(gghlite_store_t self, const uint32_t program, const uint32_t step, const uint32_t slot,
+                          const gghlite_enc_t op);
+
+/**
+   @brief Map the store at `filename` read-only.
+
+   Neither records nor index are read, pages are brought in when a lookup or a kernel touches them
+   and are shared between all processes mapping the same file.
+
+   @param self      uninitialised store
+   @param params    GGHLite `params` the store was created with, or params loaded or mapped from them
+   @param filename  store written by @ref gghlite_store_create
+
+   @ingroup store
+*/
+
+void gghlite_store_open(gghlite_store_t self, const gghlite_params_t params, const char *filename);
+
+/**
+   @brief Point `rop` at the encoding stored under (`program`, `step`, `slot`).
+
+   `rop` is a read-only view into the mapping which may be passed as an input to the functions of
+   @ref mpn, e.g. @ref gghlite_enc_mpn_mul or @ref gghlite_enc_mpn_is_zero. It owns no memory and
+   is valid until `self` is cleared.
+
+   @param rop   uninitialised encoding, return value
+   @param self  store opened by @ref gghlite_store_open
+   @return 1 if the key was found, 0 otherwise in which case `rop` is unchanged
+
+   @ingroup store
+*/
+
+int gghlite_store_get(gghlite_enc_mpn_view_t rop, const gghlite_store_t self, const uint32_t program,
+                      const uint32_t step, const uint32_t slot);
+
+/**
+   @brief Clear store.
+
+   A store being written is completed by appending its sorted index and finalising its header; a
+   store which was not cleared after writing is rejected by @ref gghlite_store_open. A mapped store
+   is unmapped, invalidating all views handed out by @ref gghlite_store_get.
+
+   @ingroup store
+*/
+
+void gghlite_store_clear(gghlite_store_t self);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,361 @@
+/**
+   @file gghlite.hpp
+   @brief GGHLite C++ API
+
+   A header-only layer over @ref gghlite.h. Keys, encodings and clear texts are owned by move-only
+   objects. Arithmetic on encodings builds expression templates, which are evaluated when assigned
+   to an encoding in a single pass over the slots of the NTT domain without intermediate encodings:
+
+       gghlite::Encoding r = a*b + c*d - e;
+
+   Per slot, sums of products are accumulated without reduction and reduced modulo $q$ once, as in
+   @ref gghlite_enc_dot. Scratch integers are taken from a per-thread pool which is reused by all
+   expressions evaluated on that thread.
+
+   @note Expressions hold references to the encodings they read, they must be evaluated before any of
+   those encodings is destroyed. Encodings hold a pointer to the `params` they were created from.
+*/
+
+#ifndef _GGHLITE_HPP_
+#define _GGHLITE_HPP_
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/* gmp.h declares C++ stream operators, include it outside of the extern "C" block of gghlite.h */
+#include <gmp.h>
+#include <mpfr.h>
+#include "gghlite.h"
+
+namespace gghlite {
+
+/**
+   @brief Modulus data used while evaluating an expression in one slot.
+*/
+
+struct EvalContext {
+    const fmpz *q;  //!< modulus $q$
+    size_t nlimbs;  //!< number of limbs of $q$, larger operands of a product are reduced first
+};
+
+/**
+   @brief Per-thread pool of scratch integers, grown on demand and never shrunk.
+*/
+
+class ScratchPool {
+    std::vector<fmpz> v_;
+
+public:
+    ScratchPool() {}
+    ScratchPool(const ScratchPool &) = delete;
+    ScratchPool &operator=(const ScratchPool &) = delete;
+
+    ~ScratchPool() {
+        for(size_t i=0; i<v_.size(); i++)
+            fmpz_clear(&v_[i]);
+    }
+
+    /** Return at least `n` initialised integers. */
+    fmpz *get(const size_t n) {
+        if (v_.size() < n)
+            v_.resize(n, 0);
+        return v_.data();
+    }
+
+    /** Return the pool of the calling thread. */
+    static ScratchPool &local() {
+        static thread_local ScratchPool pool;
+        return pool;
+    }
+};
+
+/**
+   @brief Base of all expressions over encodings, `E` is the derived type.
+*/
+
+template<class E>
+struct Expr {
+    const E &self() const { return static_cast<const E &>(*this); }
+};
+
+class Encoding;
+
+/**
+   Leaves are held by reference, inner nodes by value so that the temporaries of an expression may go
+   out of scope before it is evaluated.
+*/
+
+template<class E> struct ExprStorage { typedef const E type; };
+template<> struct ExprStorage<Encoding> { typedef const Encoding &type; };
+
+/**
+   @brief Inner node of an expression applying `Op` to two sub-expressions.
+*/
+
+template<class Op, class L, class R>
+class BinExpr : public Expr< BinExpr<Op, L, R> > {
+    typename ExprStorage<L>::type l_;
+    typename ExprStorage<R>::type r_;
+
+public:
+    static constexpr size_t ntemps = Op::ntemps + L::ntemps + R::ntemps; //!< scratch integers required
+
+    BinExpr(const L &l, const R &r) : l_(l), r_(r) {}
+
+    const struct _gghlite_params_struct *params() const { return l_.params(); }
+
+    /** Return the value of slot `i` modulo $q$, not necessarily reduced, using `t[0 … ntemps-1]`. */
+    const fmpz *eval(const size_t i, fmpz *t, const EvalContext &ctx) const {
+        const fmpz *x = l_.eval(i, t + Op::ntemps, ctx);
+        const fmpz *y = r_.eval(i, t + Op::ntemps + L::ntemps, ctx);
+        return Op::apply(t, x, y, ctx);
+    }
+};
+
+struct AddOp {
+    static constexpr size_t ntemps = 1;
+    static const fmpz *apply(fmpz *t, const fmpz *x, const fmpz *y, const EvalContext &) {
+        fmpz_add(t, x, y);
+        return t;
+    }
+};
+
+struct SubOp {
+    static constexpr size_t ntemps = 1;
+    static const fmpz *apply(fmpz *t, const fmpz *x, const fmpz *y, const EvalContext &) {
+        fmpz_sub(t, x, y);
+        return t;
+    }
+};
+
+struct MulOp {
+    static constexpr size_t ntemps = 2;
+    static const fmpz *apply(fmpz *t, const fmpz *x, const fmpz *y, const EvalContext &ctx) {
+        /* operands are sums or products, reduce them when they outgrow q */
+        if ((size_t)fmpz_size(x) > ctx.nlimbs || fmpz_sgn(x) < 0) {
+            fmpz_mod(t, x, ctx.q);
+            x = t;
+        }
+        if ((size_t)fmpz_size(y) > ctx.nlimbs || fmpz_sgn(y) < 0) {
+            fmpz_mod(t + 1, y, ctx.q);
+            y = t + 1;
+        }
+        fmpz_mul(t, x, y);
+        return t;
+    }
+};
+
+template<class L, class R>
+inline BinExpr<AddOp, L, R> operator+(const Expr<L> &l, const Expr<R> &r) {
+    return BinExpr<AddOp, L, R>(l.self(), r.self());
+}
+
+template<class L, class R>
+inline BinExpr<SubOp, L, R> operator-(const Expr<L> &l, const Expr<R> &r) {
+    return BinExpr<SubOp, L, R>(l.self(), r.self());
+}
+
+template<class L, class R>
+inline BinExpr<MulOp, L, R> operator*(const Expr<L> &l, const Expr<R> &r) {
+    return BinExpr<MulOp, L, R>(l.self(), r.self());
+}
+
+/**
+   @brief Clear text, owns a `gghlite_clr_t`.
+*/
+
+class Cleartext {
+    gghlite_clr_t f_;
+
+public:
+    Cleartext() { gghlite_clr_init(f_); }
+    ~Cleartext() { gghlite_clr_clear(f_); }
+
+    Cleartext(const Cleartext &) = delete;
+    Cleartext &operator=(const Cleartext &) = delete;
+
+    Cleartext(Cleartext &&other) noexcept {
+        gghlite_clr_init(f_);
+        fmpz_poly_swap(f_, other.f_);
+    }
+
+    Cleartext &operator=(Cleartext &&other) noexcept {
+        fmpz_poly_swap(f_, other.f_);
+        return *this;
+    }
+
+    /** Return a deep copy. */
+    Cleartext clone() const {
+        Cleartext r;
+        fmpz_poly_set(r.f_, f_);
+        return r;
+    }
+
+    fmpz_poly_struct *get() { return f_; }
+    const fmpz_poly_struct *get() const { return f_; }
+
+    bool operator==(const Cleartext &other) const { return gghlite_clr_equal(f_, other.f_); }
+    bool operator!=(const Cleartext &other) const { return !(*this == other); }
+};
+
+/**
+   @brief GGHLite instance, owns a `gghlite_sk_t`.
+
+   The instance is held on the heap so that pointers to its `params` stay valid when it is moved.
+*/
+
+class Key {
+    struct _gghlite_sk_struct *sk_;
+
+public:
+    /** @see gghlite_init */
+    Key(const size_t lambda, const size_t kappa, const size_t gamma, const uint64_t rerand_mask,
+        const gghlite_flag_t flags, aes_randstate_t randstate)
+        : sk_(new struct _gghlite_sk_struct) {
+        gghlite_init(sk_, lambda, kappa, gamma, rerand_mask, flags, randstate);
+    }
+
+    ~Key() {
+        if (sk_) {
+            gghlite_sk_clear(sk_, 1);
+            delete sk_;
+        }
+    }
+
+    Key(const Key &) = delete;
+    Key &operator=(const Key &) = delete;
+
+    Key(Key &&other) noexcept : sk_(other.sk_) { other.sk_ = NULL; }
+
+    Key &operator=(Key &&other) noexcept {
+        std::swap(sk_, other.sk_);
+        return *this;
+    }
+
+    struct _gghlite_sk_struct *get() { return sk_; }
+    const struct _gghlite_sk_struct *get() const { return sk_; }
+    const struct _gghlite_params_struct *params() const { return sk_->params; }
+
+    /** Encode `f` at level $k$ in the index set $S$, cf. @ref gghlite_enc_set_gghlite_clr_index. */
+    inline Encoding encode(const Cleartext &f, const size_t k, const gghlite_index_t S, const int rerand) const;
+};
+
+/**
+   @brief Encoding, owns a `gghlite_enc_t`.
+
+   Assigning an expression evaluates it slot by slot, distributing slots among the threads of the
+   NTT pre-computation. The encoding itself may occur in the expression.
+*/
+
+class Encoding : public Expr<Encoding> {
+    gghlite_enc_t e_;
+    const struct _gghlite_params_struct *params_;
+
+    template<class E>
+    void assign(const E &expr) {
+        const size_t n = params_->n;
+        const EvalContext ctx = {params_->q, (size_t)fmpz_size(params_->q)};
+        const int nthreads = _fmpz_mod_poly_oz_ntt_nthreads(params_->ntt);
+
+        /* slot i only reads slot i, so e_ may occur in expr; the length is updated last */
+        fmpz_mod_poly_realloc(e_, n);
+#pragma omp parallel num_threads(nthreads) if(nthreads > 1)
+        {
+            fmpz *t = ScratchPool::local().get(E::ntemps);
+#pragma omp for
+            for(size_t i=0; i<n; i++)
+                fmpz_mod(e_->coeffs + i, expr.eval(i, t, ctx), params_->q);
+        }
+        e_->length = n;
+        _fmpz_mod_poly_normalise(e_);
+    }
+
+public:
+    static constexpr size_t ntemps = 0; //!< scratch integers required when read in an expression
+
+    /** An encoding of zero at level 0. */
+    explicit Encoding(const struct _gghlite_params_struct *params) : params_(params) {
+        gghlite_enc_init(e_, params);
+    }
+
+    explicit Encoding(const Key &key) : Encoding(key.params()) {}
+
+    template<class E>
+    Encoding(const Expr<E> &expr) : Encoding(expr.self().params()) {
+        assign(expr.self());
+    }
+
+    ~Encoding() { gghlite_enc_clear(e_); }
+
+    Encoding(const Encoding &) = delete;
+    Encoding &operator=(const Encoding &) = delete;
+
+    /** The moved-from encoding is zero without any allocated coefficients. */
+    Encoding(Encoding &&other) noexcept : params_(other.params_) {
+        fmpz_mod_poly_init(e_, params_->q);
+        fmpz_mod_poly_swap(e_, other.e_);
+    }
+
+    Encoding &operator=(Encoding &&other) noexcept {
+        fmpz_mod_poly_swap(e_, other.e_);
+        std::swap(params_, other.params_);
+        return *this;
+    }
+
+    template<class E>
+    Encoding &operator=(const Expr<E> &expr) {
+        assign(expr.self());
+        return *this;
+    }
+
+    template<class E>
+    Encoding &operator+=(const Expr<E> &expr) { return *this = *this + expr; }
+
+    template<class E>
+    Encoding &operator-=(const Expr<E> &expr) { return *this = *this - expr; }
+
+    template<class E>
+    Encoding &operator*=(const Expr<E> &expr) { return *this = *this * expr; }
+
+    /** Return a deep copy. */
+    Encoding clone() const {
+        Encoding r(params_);
+        fmpz_mod_poly_set(r.e_, e_);
+        return r;
+    }
+
+    fmpz_mod_poly_struct *get() { return e_; }
+    const fmpz_mod_poly_struct *get() const { return e_; }
+    const struct _gghlite_params_struct *params() const { return params_; }
+
+    /** Return slot `i`. */
+    const fmpz *eval(const size_t i, fmpz *, const EvalContext &) const {
+        static const fmpz zero = 0;
+        return (i < (size_t)e_->length) ? e_->coeffs + i : &zero;
+    }
+
+    /** @see gghlite_enc_is_zero */
+    bool is_zero() const { return gghlite_enc_is_zero(params_, e_); }
+
+    /** @see gghlite_enc_equal */
+    bool operator==(const Encoding &other) const { return gghlite_enc_equal(params_, e_, other.e_); }
+    bool operator!=(const Encoding &other) const { return !(*this == other); }
+
+    /** @see gghlite_enc_extract */
+    Cleartext extract() const {
+        Cleartext r;
+        gghlite_enc_extract(r.get(), params_, e_);
+        return r;
+    }
+};
+
+inline Encoding Key::encode(const Cleartext &f, const size_t k, const gghlite_index_t S, const int rerand) const {
+    Encoding r(params());
+    gghlite_enc_set_gghlite_clr_index(r.get(), sk_, f.get(), k, S, rerand);
+    return r;
+}
+
+} // namespace gghlite
+
+#endif //_GGHLITE_HPP_
@@ -1,4 +1,6 @@
 #include <string.h>
+#include <omp.h>
+#include <sys/mman.h>
 
 #include "gghlite-internals.h"
 #include "gghlite.h"
@@ -39,6 +41,31 @@ _gghlite_params_set_ell(gghlite_params_t self)
     mpfr_clear(tmp);
 }
 
+/**
+   Set $q = \\prod p_i$ to a product of `OZ_RNS_PRIME_BITS`-bit primes $p_i \\equiv 1 \\bmod 2n$
+   with at least `bits` bits.
+*/
+static void
+_gghlite_params_set_q_rns(gghlite_params_t self, const size_t bits)
+{
+    const mp_limb_t m = 2*self->n;
+    mp_limb_t p = ((UWORD(1)<<OZ_RNS_PRIME_BITS)/m)*m + 1;
+
+    free(self->primes);
+    self->primes = NULL;
+    self->nprimes = 0;
+
+    fmpz_one(self->q);
+    while(fmpz_sizeinbase(self->q, 2) < bits) {
+        p = _n_prev_oz_good_probaprime(p, m);
+        if (p == 0)
+            ggh_die("Not enough primes p ≡ 1 mod 2n.");
+        self->primes = realloc(self->primes, (self->nprimes+1)*sizeof(mp_limb_t));
+        self->primes[self->nprimes++] = p;
+        fmpz_mul_ui(self->q, self->q, p);
+    }
+}
+
 static void
 _gghlite_params_set_q(gghlite_params_t self)
 {
@@ -107,6 +134,11 @@ _gghlite_params_set_q(gghlite_params_t self)
     mpfr_clear(log_q_base);
     mpfr_clear(q_base);
 
+    if (self->flags & GGHLITE_FLAGS_RNS) {
+        _gghlite_params_set_q_rns(self, fmpz_sizeinbase(self->q, 2));
+        return;
+    }
+
     fmpz_fdiv_q_2exp(self->q, self->q, n_flog(self->n,2)+1);
     fmpz_mul_2exp(self->q, self->q, n_flog(self->n,2)+1);
     fmpz_add_ui(self->q, self->q, 1);
@@ -578,6 +610,7 @@ gghlite_params_init_gamma(gghlite_params_t self, size_t lambda, size_t kappa,
         _gghlite_params_set_ell_g(self);
         _gghlite_params_set_ell(self);
         _gghlite_params_set_sigma_p(self);
+        _gghlite_params_set_ell_b(self);
         _gghlite_params_set_sigma_s(self);
         _gghlite_params_set_q(self);
 
@@ -596,11 +629,79 @@ gghlite_params_init_gamma(gghlite_params_t self, size_t lambda, size_t kappa,
         gghlite_params_print(self);
 }
 
+void
+_gghlite_params_set_zt_bound(gghlite_params_t self)
+{
+    mpfr_t bound, ex;
+    mpz_t b;
+
+    mpfr_init2(bound, _gghlite_prec(self));
+    mpfr_init2(ex, _gghlite_prec(self));
+    mpz_init(b);
+
+    /* bound = q^{1-ξ} */
+    _gghlite_params_get_q_mpfr(bound, self, MPFR_RNDN);
+    mpfr_ui_sub(ex, 1, self->xi, MPFR_RNDN);
+    mpfr_pow(bound, bound, ex, MPFR_RNDN);
+
+    mpfr_get_z(b, bound, MPFR_RNDD);
+    self->zt_bound_bits = mpz_sizeinbase(b, 2);
+
+    mpfr_sqr(bound, bound, MPFR_RNDN);
+    mpfr_get_z(b, bound, MPFR_RNDD);
+    fmpz_set_mpz(self->zt_bound2, b);
+
+    mpz_clear(b);
+    mpfr_clear(ex);
+    mpfr_clear(bound);
+}
+
+void
+gghlite_params_set_D_sigmas(gghlite_params_t self)
+{
+    assert(self->n);
+    assert(mpfr_cmp_d(self->sigma_p, 0) > 0);
+
+    const oz_flag_t flags = (self->flags & GGHLITE_FLAGS_VERBOSE) ? OZ_VERBOSE : 0;
+    self->D_sigma_p = _gghlite_dgsl_from_n(self->n, self->sigma_p, flags);
+    if (self->rerand_mask)
+        self->D_sigma_s = _gghlite_dgsl_from_n(self->n, self->sigma_s, flags);
+}
+
 void
 gghlite_params_clear(gghlite_params_t self)
 {
-    fmpz_mod_poly_clear(self->pzt);
+    const size_t bound = (gghlite_params_is_symmetric(self)) ? 1 : self->gamma;
+
+    if (self->x) {
+        for(size_t i=0; i<bound; i++) {
+            for(size_t k=0; k<self->kappa; k++) {
+                if (self->x[i][k] == NULL)
+                    continue;
+                gghlite_enc_clear(self->x[i][k][0]);
+                gghlite_enc_clear(self->x[i][k][1]);
+                free(self->x[i][k]);
+            }
+            free(self->x[i]);
+        }
+        free(self->x);
+    }
+    if (self->y) {
+        for(size_t i=0; i<bound; i++)
+            gghlite_enc_clear(self->y[i]);
+        free(self->y);
+    }
+    if (self->D_sigma_p)
+        dgsl_rot_mp_clear(self->D_sigma_p);
+    if (self->D_sigma_s)
+        dgsl_rot_mp_clear(self->D_sigma_s);
 
+    fmpz_mod_poly_clear(self->pzt);
+    if (!self->map) {
+        fmpz_mod_poly_oz_mpn_clear(self->pzt_mpn_buf);
+        free(self->zt_rows_buf);
+    }
+    fmpz_clear(self->zt_bound2);
     mpfr_clear(self->xi);
     mpfr_clear(self->sigma_s);
     mpfr_clear(self->ell_b);
@@ -608,7 +709,14 @@ gghlite_params_clear(gghlite_params_t self)
     mpfr_clear(self->ell_g);
     mpfr_clear(self->sigma);
     fmpz_mod_poly_oz_ntt_precomp_clear(self->ntt);
+    if (self->flags & GGHLITE_FLAGS_RNS) {
+        fmpz_mod_poly_oz_rns_clear(self->pzt_rns);
+        fmpz_mod_poly_oz_rns_precomp_clear(self->rns);
+    }
+    free(self->primes);
     fmpz_clear(self->q);
+    if (self->map)
+        munmap(self->map, self->map_size);
 }
 
 void
@@ -617,6 +725,19 @@ gghlite_params_ref(gghlite_params_t rop, gghlite_sk_t op)
     memcpy(rop, op->params, sizeof(struct _gghlite_params_struct));
 }
 
+void
+gghlite_params_set_nthreads(gghlite_params_t self, int nthreads)
+{
+    self->nthreads = (nthreads > 0) ? nthreads : 0;
+    nthreads = (self->nthreads) ? self->nthreads : omp_get_max_threads();
+
+    /* the pre-computation only exists once gghlite_sk_init was called */
+    if (self->ntt->n)
+        fmpz_mod_poly_oz_ntt_precomp_set_nthreads(self->ntt, nthreads);
+    if ((self->flags & GGHLITE_FLAGS_RNS) && self->rns->n)
+        fmpz_mod_poly_oz_rns_precomp_set_nthreads(self->rns, nthreads);
+}
+
 /**
  * Tests a bunch of kappa values to see encoding sizes
  */
@@ -684,6 +805,8 @@ gghlite_params_print(const gghlite_params_t self)
     printf("        n: %9ld,        δ_0: %9.6f\n",n, gghlite_params_get_delta_0(self));
     printf("log(t_en): %9.2f,  log(t_sv): %9.2f\n", gghlite_params_cost_bkz_enum(self), gghlite_params_cost_bkz_sieve(self));
     printf("   log(q): %9ld,          ξ: %9.4f\n", fmpz_sizeinbase(self->q, 2), mpfr_get_d(self->xi, MPFR_RNDN));
+    if (self->flags & GGHLITE_FLAGS_RNS)
+        printf("  #primes: %9zu,   log(p_i): %9d\n", self->nprimes, OZ_RNS_PRIME_BITS);
     printf("   log(σ): %9.2f,   log(ℓ_g): %9.2f\n", log2(mpfr_get_d(self->sigma,   MPFR_RNDN)), log2(mpfr_get_d(self->ell_g,   MPFR_RNDN)));
     printf("  log(σ'): %9.2f,   log(ℓ_b): %9.2f\n", log2(mpfr_get_d(self->sigma_p, MPFR_RNDN)), log2(mpfr_get_d(self->ell_b,   MPFR_RNDN)));
     printf(" log(σ^*): %9.2f,   \n", log2(mpfr_get_d(self->sigma_s, MPFR_RNDN)));
@@ -692,9 +815,8 @@ gghlite_params_print(const gghlite_params_t self)
     mpfr_t enc;
     mpfr_init2(enc, _gghlite_prec(self));
 
-    _gghlite_params_get_q_mpfr(enc, self, MPFR_RNDN);
-    mpfr_log2(enc, enc, MPFR_RNDN);
-    mpfr_mul_ui(enc, enc, n, MPFR_RNDN);
+    /* bits on the wire, cf. gghlite_enc_pack */
+    mpfr_set_ui(enc, 8*gghlite_enc_packed_size(self), MPFR_RNDN);
 
     const char *units[3] = {"KB","MB","GB"};
 
@@ -0,0 +1,682 @@
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "gghlite-internals.h"
+#include "gghlite.h"
+#include "oz/oz.h"
+
+/*
+  File layout, all integers in native byte order:
+
+  - header: GGHLITE_FILE_MAGIC, version, kind, bits per limb and a byte order tag as uint32_t
+  - public parameters, cf. _gghlite_params_write
+  - secret key if kind is _GGHLITE_FILE_SK, cf. gghlite_sk_save
+
+  Files of kind _GGHLITE_FILE_MAPPED instead hold the parameters needed for evaluation followed by
+  the limb arrays the kernels read, each starting at a multiple of GGHLITE_MAP_ALIGN bytes, cf.
+  gghlite_params_save_mappable.
+
+  Integers are stored as their signed limb count followed by their limbs and encodings as
+  ⌈log₂ q / w⌉ limbs per coefficient, so loading amounts to copying limbs. Files are thus only
+  portable between machines with the same limb size and byte order, which the header records.
+*/
+
+static void
+_gghlite_write(FILE *fh, const void *buf, const size_t size)
+{
+    if (size && fwrite(buf, 1, size, fh) != size)
+        ggh_die("failed to write %zu bytes", size);
+}
+
+static void
+_gghlite_read(void *buf, const size_t size, FILE *fh)
+{
+    if (size && fread(buf, 1, size, fh) != size)
+        ggh_die("failed to read %zu bytes, file truncated?", size);
+}
+
+static void
+_gghlite_write_u64(FILE *fh, const uint64_t op)
+{
+    _gghlite_write(fh, &op, sizeof(uint64_t));
+}
+
+static uint64_t
+_gghlite_read_u64(FILE *fh)
+{
+    uint64_t rop;
+    _gghlite_read(&rop, sizeof(uint64_t), fh);
+    return rop;
+}
+
+static void
+_gghlite_write_header(FILE *fh, const uint32_t kind)
+{
+    const uint32_t header[4] = {GGHLITE_FILE_VERSION, kind, FLINT_BITS, _GGHLITE_FILE_BYTE_ORDER};
+    _gghlite_write(fh, GGHLITE_FILE_MAGIC, strlen(GGHLITE_FILE_MAGIC));
+    _gghlite_write(fh, header, sizeof(header));
+}
+
+/**
+   Check the header and return the kind of file.
+*/
+
+static uint32_t
+_gghlite_read_header(FILE *fh)
+{
+    char magic[sizeof(GGHLITE_FILE_MAGIC)];
+    uint32_t header[4];
+
+    _gghlite_read(magic, strlen(GGHLITE_FILE_MAGIC), fh);
+    if (memcmp(magic, GGHLITE_FILE_MAGIC, strlen(GGHLITE_FILE_MAGIC)))
+        ggh_die("not a GGHLite file");
+    _gghlite_read(header, sizeof(header), fh);
+    if (header[0] != GGHLITE_FILE_VERSION)
+        ggh_die("unsupported file version %u, expected %u", header[0], GGHLITE_FILE_VERSION);
+    if (header[2] != FLINT_BITS || header[3] != _GGHLITE_FILE_BYTE_ORDER)
+        ggh_die("file was written on a machine with %u-bit limbs or a different byte order", header[2]);
+    if (header[1] != _GGHLITE_FILE_PARAMS && header[1] != _GGHLITE_FILE_SK && header[1] != _GGHLITE_FILE_MAPPED)
+        ggh_die("unknown file kind %u", header[1]);
+    return header[1];
+}
+
+/* integers */
+
+static void
+_gghlite_write_fmpz(FILE *fh, const fmpz_t op)
+{
+    if (!COEFF_IS_MPZ(*op)) {
+        const mp_limb_t c = FLINT_ABS(*op);
+        _gghlite_write_u64(fh, (uint64_t)(int64_t)fmpz_sgn(op));
+        if (c)
+            _gghlite_write(fh, &c, sizeof(mp_limb_t));
+    } else {
+        const __mpz_struct *z = COEFF_TO_PTR(*op);
+        _gghlite_write_u64(fh, (uint64_t)(int64_t)z->_mp_size);
+        _gghlite_write(fh, z->_mp_d, FLINT_ABS(z->_mp_size) * sizeof(mp_limb_t));
+    }
+}
+
+static void
+_gghlite_read_fmpz(fmpz_t rop, FILE *fh)
+{
+    const int64_t size = (int64_t)_gghlite_read_u64(fh);
+    const mp_size_t n = (size < 0) ? -size : size;
+
+    if (n <= 1) {
+        mp_limb_t c = 0;
+        _gghlite_read(&c, n * sizeof(mp_limb_t), fh);
+        fmpz_set_ui(rop, c);
+        if (size < 0)
+            fmpz_neg(rop, rop);
+    } else {
+        __mpz_struct *z = _fmpz_promote(rop);
+        if (z->_mp_alloc < n)
+            mpz_realloc2(z, n * FLINT_BITS);
+        _gghlite_read(z->_mp_d, n * sizeof(mp_limb_t), fh);
+        z->_mp_size = size;
+    }
+}
+
+static void
+_gghlite_write_fmpz_poly(FILE *fh, const fmpz_poly_t op)
+{
+    _gghlite_write_u64(fh, op->length);
+    for(slong i=0; i<op->length; i++)
+        _gghlite_write_fmpz(fh, op->coeffs + i);
+}
+
+static void
+_gghlite_read_fmpz_poly(fmpz_poly_t rop, FILE *fh)
+{
+    const slong len = _gghlite_read_u64(fh);
+    fmpz_poly_fit_length(rop, len);
+    for(slong i=0; i<len; i++)
+        _gghlite_read_fmpz(rop->coeffs + i, fh);
+    _fmpz_poly_set_length(rop, len);
+    _fmpz_poly_normalise(rop);
+}
+
+static void
+_gghlite_write_fmpq_poly(FILE *fh, const fmpq_poly_t op)
+{
+    _gghlite_write_fmpz(fh, fmpq_poly_denref(op));
+    _gghlite_write_u64(fh, op->length);
+    for(slong i=0; i<op->length; i++)
+        _gghlite_write_fmpz(fh, op->coeffs + i);
+}
+
+static void
+_gghlite_read_fmpq_poly(fmpq_poly_t rop, FILE *fh)
+{
+    _gghlite_read_fmpz(fmpq_poly_denref(rop), fh);
+    const slong len = _gghlite_read_u64(fh);
+    fmpq_poly_fit_length(rop, len);
+    for(slong i=0; i<len; i++)
+        _gghlite_read_fmpz(rop->coeffs + i, fh);
+    _fmpq_poly_set_length(rop, len);
+    _fmpq_poly_normalise(rop);
+}
+
+/* floating point numbers: precision, exponent and the exact hexadecimal digits from mpfr_get_str */
+
+static void
+_gghlite_write_mpfr(FILE *fh, const mpfr_t op)
+{
+    mpfr_exp_t e = 0;
+    char *s = mpfr_get_str(NULL, &e, 16, 0, op, MPFR_RNDN);
+    if (s == NULL)
+        ggh_die("failed to convert floating point number");
+    const size_t len = strlen(s);
+    _gghlite_write_u64(fh, mpfr_get_prec(op));
+    _gghlite_write_u64(fh, (uint64_t)(int64_t)e);
+    _gghlite_write_u64(fh, len);
+    _gghlite_write(fh, s, len);
+    mpfr_free_str(s);
+}
+
+static void
+_gghlite_read_mpfr(mpfr_t rop, FILE *fh)
+{
+    const mpfr_prec_t prec = _gghlite_read_u64(fh);
+    if (prec < MPFR_PREC_MIN || prec > MPFR_PREC_MAX)
+        ggh_die("invalid precision %ld", (long)prec);
+    const long e = (long)(int64_t)_gghlite_read_u64(fh);
+    const size_t len = _gghlite_read_u64(fh);
+    /* a sign, one digit per four bits and one more, or "-@Inf@" */
+    if (len == 0 || len > (size_t)prec/4 + 8)
+        ggh_die("invalid floating point number of %zu digits at precision %ld", len, (long)prec);
+
+    char *d = (char*)malloc(len + 1);
+    if (d == NULL)
+        ggh_die("failed to allocate %zu bytes", len + 1);
+    _gghlite_read(d, len, fh);
+    d[len] = '\0';
+
+    mpfr_set_prec(rop, prec);
+    if (strchr(d, '@')) {
+        /* NaN or infinity, the exponent is meaningless */
+        mpfr_set_str(rop, d, 16, MPFR_RNDN);
+    } else {
+        /* the value is 0.d × 16^e, room for "-0.", "@" and the exponent */
+        char *s = (char*)malloc(len + 32);
+        if (s == NULL)
+            ggh_die("failed to allocate %zu bytes", len + 32);
+        const int neg = (d[0] == '-');
+        sprintf(s, "%s0.%s@%ld", neg ? "-" : "", d + neg, e);
+        if (mpfr_set_str(rop, s, 16, MPFR_RNDN))
+            ggh_die("invalid floating point number '%s'", d);
+        free(s);
+    }
+    free(d);
+}
+
+/* encodings: length followed by ⌈log₂ q / w⌉ limbs per coefficient */
+
+static void
+_gghlite_write_enc(FILE *fh, const gghlite_params_t self, const gghlite_enc_t op)
+{
+    const mp_size_t l = fmpz_size(self->q);
+    const slong len = op->length;
+    mp_ptr buf = (mp_ptr)malloc((len * l + 1) * sizeof(mp_limb_t));
+    if (buf == NULL)
+        ggh_die("failed to allocate %zu limbs", (size_t)(len * l));
+    fmpz_t tmp;
+    fmpz_init(tmp);
+    for(slong i=0; i<len; i++) {
+        const fmpz *c = op->coeffs + i;
+        /* lazily reduced coefficients, cf. gghlite_enc_add_lazy, do not fit l limbs */
+        if (fmpz_sgn(c) < 0 || fmpz_cmp(c, self->q) >= 0) {
+            fmpz_mod(tmp, c, self->q);
+            c = tmp;
+        }
+        _fmpz_oz_get_mpn(buf + i*l, l, c);
+    }
+    fmpz_clear(tmp);
+    _gghlite_write_u64(fh, len);
+    _gghlite_write(fh, buf, len * l * sizeof(mp_limb_t));
+    free(buf);
+}
+
+static void
+_gghlite_read_enc(gghlite_enc_t rop, const gghlite_params_t self, FILE *fh)
+{
+    const mp_size_t l = fmpz_size(self->q);
+    const slong len = _gghlite_read_u64(fh);
+    if (len < 0 || len > self->n)
+        ggh_die("encoding of length %ld exceeds dimension %ld", (long)len, self->n);
+    mp_ptr buf = (mp_ptr)malloc((len * l + 1) * sizeof(mp_limb_t));
+    if (buf == NULL)
+        ggh_die("failed to allocate %zu limbs", (size_t)(len * l));
+    _gghlite_read(buf, len * l * sizeof(mp_limb_t), fh);
+
+    fmpz_mod_poly_fit_length(rop, len);
+    for(slong i=0; i<len; i++)
+        _fmpz_oz_set_mpn(rop->coeffs + i, buf + i*l, l);
+    rop->length = len;
+    _fmpz_mod_poly_normalise(rop);
+    free(buf);
+}
+
+/* public parameters */
+
+static void
+_gghlite_params_write(FILE *fh, const gghlite_params_t self)
+{
+    assert(self->n);
+    assert(!fmpz_is_zero(self->q));
+
+    _gghlite_write_u64(fh, self->lambda);
+    _gghlite_write_u64(fh, self->kappa);
+    _gghlite_write_u64(fh, self->gamma);
+    _gghlite_write_u64(fh, self->rerand_mask);
+    _gghlite_write_u64(fh, self->flags);
+    _gghlite_write_u64(fh, self->n);
+    _gghlite_write_u64(fh, self->ell);
+
+    _gghlite_write_u64(fh, self->nprimes);
+    _gghlite_write(fh, self->primes, self->nprimes * sizeof(mp_limb_t));
+    _gghlite_write_fmpz(fh, self->q);
+
+    _gghlite_write_mpfr(fh, self->sigma);
+    _gghlite_write_mpfr(fh, self->sigma_p);
+    _gghlite_write_mpfr(fh, self->sigma_s);
+    _gghlite_write_mpfr(fh, self->ell_b);
+    _gghlite_write_mpfr(fh, self->ell_g);
+    _gghlite_write_mpfr(fh, self->xi);
+
+    /* the pre-computation is determined by its root of unity, finding it is the expensive part */
+    fmpz_t phi;
+    fmpz_init(phi);
+    fmpz_mod_poly_oz_ntt_precomp_get_root(phi, self->ntt);
+    _gghlite_write_fmpz(fh, phi);
+    fmpz_clear(phi);
+
+    if (self->map) {
+        /* mapped params only hold p_zt in pzt_mpn */
+        gghlite_enc_t pzt;
+        gghlite_enc_init(pzt, self);
+        fmpz_mod_poly_oz_mpn_get_fmpz_mod_poly(pzt, self->pzt_mpn, self->ntt);
+        _gghlite_write_enc(fh, self, pzt);
+        gghlite_enc_clear(pzt);
+    } else {
+        _gghlite_write_enc(fh, self, self->pzt);
+    }
+    _gghlite_write_u64(fh, self->zt_nrows);
+    _gghlite_write(fh, self->zt_rows, self->zt_nrows * self->n * self->ntt->mont->nlimbs * sizeof(mp_limb_t));
+
+    if (!self->rerand_mask)
+        return;
+
+    const size_t bound = (gghlite_params_is_symmetric(self)) ? 1 : self->gamma;
+    for(size_t i=0; i<bound; i++)
+        _gghlite_write_enc(fh, self, self->y[i]);
+    for(size_t i=0; i<bound; i++) {
+        for(size_t k=0; k<self->kappa; k++) {
+            if (!gghlite_params_have_rerand(self, k))
+                continue;
+            _gghlite_write_enc(fh, self, self->x[i][k][0]);
+            _gghlite_write_enc(fh, self, self->x[i][k][1]);
+        }
+    }
+}
+
+static void
+_gghlite_params_read(gghlite_params_t self, FILE *fh)
+{
+    const size_t lambda = _gghlite_read_u64(fh);
+    const size_t kappa  = _gghlite_read_u64(fh);
+    const size_t gamma  = _gghlite_read_u64(fh);
+    gghlite_params_initzero(self, lambda, kappa, gamma);
+
+    self->rerand_mask = _gghlite_read_u64(fh);
+    self->flags = _gghlite_read_u64(fh);
+    self->n = _gghlite_read_u64(fh);
+    self->ell = _gghlite_read_u64(fh);
+    if (self->n < 2 || (self->n & (self->n - 1)))
+        ggh_die("invalid dimension %ld", self->n);
+
+    self->nprimes = _gghlite_read_u64(fh);
+    if (self->nprimes) {
+        self->primes = (mp_limb_t*)malloc(self->nprimes * sizeof(mp_limb_t));
+        if (self->primes == NULL)
+            ggh_die("failed to allocate %zu primes", self->nprimes);
+        _gghlite_read(self->primes, self->nprimes * sizeof(mp_limb_t), fh);
+    }
+    _gghlite_read_fmpz(self->q, fh);
+
+    _gghlite_read_mpfr(self->sigma, fh);
+    _gghlite_read_mpfr(self->sigma_p, fh);
+    _gghlite_read_mpfr(self->sigma_s, fh);
+    _gghlite_read_mpfr(self->ell_b, fh);
+    _gghlite_read_mpfr(self->ell_g, fh);
+    _gghlite_read_mpfr(self->xi, fh);
+
+    fmpz_t phi;
+    fmpz_init(phi);
+    _gghlite_read_fmpz(phi, fh);
+    _gghlite_params_init_precomp(self, phi);
+    fmpz_clear(phi);
+
+    fmpz_mod_poly_init(self->pzt, self->q);
+    _gghlite_read_enc(self->pzt, self, fh);
+    _gghlite_params_set_zt_bound(self);
+
+    self->zt_nrows = _gghlite_read_u64(fh);
+    if (self->zt_nrows) {
+        const size_t nlimbs = self->zt_nrows * self->n * self->ntt->mont->nlimbs;
+        self->zt_rows_buf = (mp_ptr)malloc(nlimbs * sizeof(mp_limb_t));
+        if (self->zt_rows_buf == NULL)
+            ggh_die("failed to allocate zero-testing rows");
+        _gghlite_read(self->zt_rows_buf, nlimbs * sizeof(mp_limb_t), fh);
+        self->zt_rows = self->zt_rows_buf;
+    }
+
+    if (self->flags & GGHLITE_FLAGS_RNS) {
+        gghlite_enc_rns_init(self->pzt_rns, self);
+        gghlite_enc_rns_set_gghlite_enc(self->pzt_rns, self, self->pzt);
+    }
+    gghlite_enc_mpn_init(self->pzt_mpn_buf, self);
+    gghlite_enc_mpn_set_gghlite_enc(self->pzt_mpn_buf, self, self->pzt);
+    *self->pzt_mpn = *self->pzt_mpn_buf->view;
+
+    gghlite_params_set_D_sigmas(self);
+
+    if (!self->rerand_mask)
+        return;
+
+    const size_t bound = (gghlite_params_is_symmetric(self)) ? 1 : self->gamma;
+    self->y = calloc(bound, sizeof(gghlite_enc_t));
+    for(size_t i=0; i<bound; i++) {
+        gghlite_enc_init(self->y[i], self);
+        _gghlite_read_enc(self->y[i], self, fh);
+    }
+    self->x = calloc(bound, sizeof(gghlite_enc_t **));
+    for(size_t i=0; i<bound; i++) {
+        self->x[i] = calloc(kappa, sizeof(gghlite_enc_t *));
+        for(size_t k=0; k<kappa; k++) {
+            if (!gghlite_params_have_rerand(self, k))
+                continue;
+            self->x[i][k] = calloc(2, sizeof(gghlite_enc_t));
+            for(size_t j=0; j<2; j++) {
+                gghlite_enc_init(self->x[i][k][j], self);
+                _gghlite_read_enc(self->x[i][k][j], self, fh);
+            }
+        }
+    }
+}
+
+void
+gghlite_params_save(const gghlite_params_t self, FILE *fh)
+{
+    _gghlite_write_header(fh, _GGHLITE_FILE_PARAMS);
+    _gghlite_params_write(fh, self);
+}
+
+void
+gghlite_params_load(gghlite_params_t self, FILE *fh)
+{
+    if (_gghlite_read_header(fh) == _GGHLITE_FILE_MAPPED)
+        ggh_die("file holds mappable parameters, use gghlite_params_map");
+    _gghlite_params_read(self, fh);
+}
+
+/* mappable public parameters */
+
+static size_t
+_gghlite_map_align(const size_t off)
+{
+    return (off + GGHLITE_MAP_ALIGN - 1) / GGHLITE_MAP_ALIGN * GGHLITE_MAP_ALIGN;
+}
+
+/**
+   Byte offsets of the NTT tables, `pzt_mpn` and `zt_rows` and the total size given the offset
+   `off` at which the scalar part ends.
+*/
+
+static void
+_gghlite_map_offsets(size_t offsets[4], const gghlite_params_t self, const size_t off)
+{
+    const mp_size_t l = fmpz_size(self->q);
+    const oz_flag_t ntt_flags = (self->flags & GGHLITE_FLAGS_NTT_SEEDED) ? OZ_NTT_SEEDED : 0;
+    const size_t ntables = fmpz_mod_poly_oz_ntt_precomp_tables_size(self->n, l, ntt_flags);
+
+    offsets[0] = _gghlite_map_align(off);
+    offsets[1] = _gghlite_map_align(offsets[0] + ntables * sizeof(mp_limb_t));
+    offsets[2] = _gghlite_map_align(offsets[1] + self->n * l * sizeof(mp_limb_t));
+    offsets[3] = offsets[2] + self->zt_nrows * self->n * l * sizeof(mp_limb_t);
+}
+
+static void
+_gghlite_write_padding(FILE *fh, const size_t from, const size_t to)
+{
+    static const char zeros[GGHLITE_MAP_ALIGN];
+    _gghlite_write(fh, zeros, to - from);
+}
+
+void
+gghlite_params_save_mappable(const gghlite_params_t self, FILE *fh)
+{
+    assert(self->n);
+    assert(!fmpz_is_zero(self->q));
+
+    _gghlite_write_header(fh, _GGHLITE_FILE_MAPPED);
+    _gghlite_write_u64(fh, self->lambda);
+    _gghlite_write_u64(fh, self->kappa);
+    _gghlite_write_u64(fh, self->gamma);
+    _gghlite_write_u64(fh, self->flags);
+    _gghlite_write_u64(fh, self->n);
+    _gghlite_write_u64(fh, self->ell);
+
+    _gghlite_write_u64(fh, self->nprimes);
+    _gghlite_write(fh, self->primes, self->nprimes * sizeof(mp_limb_t));
+    _gghlite_write_fmpz(fh, self->q);
+
+    _gghlite_write_mpfr(fh, self->sigma);
+    _gghlite_write_mpfr(fh, self->sigma_p);
+    _gghlite_write_mpfr(fh, self->sigma_s);
+    _gghlite_write_mpfr(fh, self->ell_b);
+    _gghlite_write_mpfr(fh, self->ell_g);
+    _gghlite_write_mpfr(fh, self->xi);
+
+    fmpz_t phi;
+    fmpz_init(phi);
+    fmpz_mod_poly_oz_ntt_precomp_get_root(phi, self->ntt);
+    _gghlite_write_fmpz(fh, phi);
+    fmpz_clear(phi);
+    _gghlite_write_u64(fh, self->zt_nrows);
+
+    const long pos = ftell(fh);
+    if (pos < 0)
+        ggh_die("mappable parameters must be written to a seekable file");
+
+    size_t offsets[4];
+    _gghlite_map_offsets(offsets, self, pos);
+    const mp_size_t l = self->ntt->mont->nlimbs;
+    const oz_flag_t ntt_flags = (self->flags & GGHLITE_FLAGS_NTT_SEEDED) ? OZ_NTT_SEEDED : 0;
+    const size_t ntables = fmpz_mod_poly_oz_ntt_precomp_tables_size(self->n, l, ntt_flags);
+
+    mp_ptr tables = (mp_ptr)malloc(ntables * sizeof(mp_limb_t));
+    if (tables == NULL)
+        ggh_die("failed to allocate %zu limbs", ntables);
+    fmpz_mod_poly_oz_ntt_precomp_get_tables(tables, self->ntt);
+
+    _gghlite_write_padding(fh, pos, offsets[0]);
+    _gghlite_write(fh, tables, ntables * sizeof(mp_limb_t));
+    _gghlite_write_padding(fh, offsets[0] + ntables * sizeof(mp_limb_t), offsets[1]);
+    _gghlite_write(fh, self->pzt_mpn->coeffs, self->n * l * sizeof(mp_limb_t));
+    _gghlite_write_padding(fh, offsets[1] + self->n * l * sizeof(mp_limb_t), offsets[2]);
+    _gghlite_write(fh, self->zt_rows, self->zt_nrows * self->n * l * sizeof(mp_limb_t));
+    free(tables);
+}
+
+void
+gghlite_params_map(gghlite_params_t self, const char *filename)
+{
+    const int fd = open(filename, O_RDONLY);
+    if (fd < 0)
+        ggh_die("failed to open '%s'", filename);
+    struct stat st;
+    if (fstat(fd, &st) || st.st_size <= 0) {
+        close(fd);
+        ggh_die("failed to stat '%s'", filename);
+    }
+    const size_t size = st.st_size;
+    void *map = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        ggh_die("failed to map '%s'", filename);
+
+    /* the scalar part is parsed with the stream readers */
+    FILE *fh = fmemopen(map, size, "r");
+    if (fh == NULL)
+        ggh_die("failed to read '%s'", filename);
+    if (_gghlite_read_header(fh) != _GGHLITE_FILE_MAPPED)
+        ggh_die("'%s' does not hold mappable parameters", filename);
+
+    const size_t lambda = _gghlite_read_u64(fh);
+    const size_t kappa  = _gghlite_read_u64(fh);
+    const size_t gamma  = _gghlite_read_u64(fh);
+    gghlite_params_initzero(self, lambda, kappa, gamma);
+
+    self->flags = _gghlite_read_u64(fh);
+    self->n = _gghlite_read_u64(fh);
+    self->ell = _gghlite_read_u64(fh);
+    if (self->n < 2 || (self->n & (self->n - 1)))
+        ggh_die("invalid dimension %ld", self->n);
+
+    self->nprimes = _gghlite_read_u64(fh);
+    if (self->nprimes) {
+        self->primes = (mp_limb_t*)malloc(self->nprimes * sizeof(mp_limb_t));
+        if (self->primes == NULL)
+            ggh_die("failed to allocate %zu primes", self->nprimes);
+        _gghlite_read(self->primes, self->nprimes * sizeof(mp_limb_t), fh);
+    }
+    _gghlite_read_fmpz(self->q, fh);
+
+    _gghlite_read_mpfr(self->sigma, fh);
+    _gghlite_read_mpfr(self->sigma_p, fh);
+    _gghlite_read_mpfr(self->sigma_s, fh);
+    _gghlite_read_mpfr(self->ell_b, fh);
+    _gghlite_read_mpfr(self->ell_g, fh);
+    _gghlite_read_mpfr(self->xi, fh);
+
+    fmpz_t phi;
+    fmpz_init(phi);
+    _gghlite_read_fmpz(phi, fh);
+    self->zt_nrows = _gghlite_read_u64(fh);
+    const long pos = ftell(fh);
+    fclose(fh);
+
+    size_t offsets[4];
+    _gghlite_map_offsets(offsets, self, pos);
+    if (offsets[3] > size)
+        ggh_die("'%s' is truncated, expected %zu bytes but found %zu", filename, offsets[3], size);
+
+    self->map = map;
+    self->map_size = size;
+
+    const oz_flag_t ntt_flags = (self->flags & GGHLITE_FLAGS_NTT_SEEDED) ? OZ_NTT_SEEDED : 0;
+    fmpz_mod_poly_oz_ntt_precomp_init_tables(self->ntt, self->n, self->q, phi,
+                                             (mp_srcptr)((char*)map + offsets[0]), ntt_flags);
+    fmpz_clear(phi);
+
+    self->pzt_mpn->n = self->n;
+    self->pzt_mpn->nlimbs = self->ntt->mont->nlimbs;
+    self->pzt_mpn->coeffs = (mp_srcptr)((const char*)map + offsets[1]);
+    if (self->zt_nrows)
+        self->zt_rows = (mp_srcptr)((const char*)map + offsets[2]);
+
+    fmpz_mod_poly_init(self->pzt, self->q);
+    _gghlite_params_set_zt_bound(self);
+
+    /* the residue tables are small but p_zt modulo each p_i is not, it is computed on the heap */
+    if (self->flags & GGHLITE_FLAGS_RNS) {
+        fmpz_mod_poly_oz_rns_precomp_init(self->rns, self->ntt, self->primes, self->nprimes);
+        gghlite_enc_t pzt;
+        gghlite_enc_init(pzt, self);
+        fmpz_mod_poly_oz_mpn_get_fmpz_mod_poly(pzt, self->pzt_mpn, self->ntt);
+        gghlite_enc_rns_init(self->pzt_rns, self);
+        gghlite_enc_rns_set_gghlite_enc(self->pzt_rns, self, pzt);
+        gghlite_enc_clear(pzt);
+    }
+
+    gghlite_params_set_D_sigmas(self);
+}
+
+/* secret key */
+
+void
+gghlite_sk_save(const gghlite_sk_t self, FILE *fh)
+{
+    assert(self->D_g);
+    assert(self->D_g->call == dgsl_rot_mp_call_inlattice);
+
+    _gghlite_write_header(fh, _GGHLITE_FILE_SK);
+    _gghlite_params_write(fh, self->params);
+
+    _gghlite_write_fmpz_poly(fh, self->g);
+    _gghlite_write_fmpq_poly(fh, self->g_inv);
+    _gghlite_write_fmpz_poly(fh, self->h);
+
+    const size_t bound = (gghlite_sk_is_symmetric(self)) ? 1 : self->params->gamma;
+    for(size_t i=0; i<bound; i++) {
+        _gghlite_write_enc(fh, self->params, self->z[i]);
+        _gghlite_write_enc(fh, self->params, self->z_inv[i]);
+    }
+
+    /* D_g->B is g */
+    _gghlite_write_mpfr(fh, self->D_g->sigma);
+    _gghlite_write_fmpq_poly(fh, self->D_g->B_inv);
+    _gghlite_write_fmpq_poly(fh, self->D_g->sigma_sqrt);
+}
+
+void
+gghlite_sk_load(gghlite_sk_t self, FILE *fh, aes_randstate_t randstate)
+{
+    memset(self, 0, sizeof(struct _gghlite_sk_struct));
+
+    if (_gghlite_read_header(fh) != _GGHLITE_FILE_SK)
+        ggh_die("file does not hold a secret key");
+    _gghlite_params_read(self->params, fh);
+    _gghlite_sk_seed_rng(self, randstate);
+
+    fmpz_poly_init(self->g);
+    fmpq_poly_init(self->g_inv);
+    fmpz_poly_init(self->h);
+    _gghlite_read_fmpz_poly(self->g, fh);
+    _gghlite_read_fmpq_poly(self->g_inv, fh);
+    _gghlite_read_fmpz_poly(self->h, fh);
+
+    const size_t bound = (gghlite_sk_is_symmetric(self)) ? 1 : self->params->gamma;
+    self->z     = calloc(self->params->gamma, sizeof(gghlite_enc_t));
+    self->z_inv = calloc(self->params->gamma, sizeof(gghlite_enc_t));
+    for(size_t i=0; i<bound; i++) {
+        fmpz_mod_poly_init(self->z[i], self->params->q);
+        fmpz_mod_poly_init(self->z_inv[i], self->params->q);
+        _gghlite_read_enc(self->z[i], self->params, fh);
+        _gghlite_read_enc(self->z_inv[i], self->params, fh);
+    }
+
+    if (gghlite_sk_is_symmetric(self))
+        _gghlite_sk_set_z_inv_pow(self);
+    else
+        _gghlite_sk_init_zcache(self, GGHLITE_ZCACHE_SIZE);
+
+    mpfr_t sigma;
+    mpfr_init2(sigma, _gghlite_prec(self->params));
+    fmpq_poly_t B_inv, sigma_sqrt;
+    fmpq_poly_init(B_inv);
+    fmpq_poly_init(sigma_sqrt);
+
+    _gghlite_read_mpfr(sigma, fh);
+    _gghlite_read_fmpq_poly(B_inv, fh);
+    _gghlite_read_fmpq_poly(sigma_sqrt, fh);
+    self->D_g = dgsl_rot_mp_init_inlattice(self->params->n, self->g, sigma, B_inv, sigma_sqrt);
+
+    fmpq_poly_clear(sigma_sqrt);
+    fmpq_poly_clear(B_inv);
+    mpfr_clear(sigma);
+}
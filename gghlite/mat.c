@@ -0,0 +1,192 @@
+#include "gghlite.h"
+
+void
+gghlite_enc_mat_init(gghlite_enc_mat_t m, const gghlite_params_t self, const size_t nrows, const size_t ncols)
+{
+    m->nrows = nrows;
+    m->ncols = ncols;
+    m->entries = (gghlite_enc_t*)calloc(nrows*ncols + 1, sizeof(gghlite_enc_t));
+    if (m->entries == NULL)
+        ggh_die("failed to allocate %zu × %zu encodings", nrows, ncols);
+    for(size_t k=0; k<nrows*ncols; k++)
+        gghlite_enc_init(m->entries[k], self);
+}
+
+void
+gghlite_enc_mat_clear(gghlite_enc_mat_t m)
+{
+    for(size_t k=0; k<m->nrows*m->ncols; k++)
+        gghlite_enc_clear(m->entries[k]);
+    free(m->entries);
+    m->entries = NULL;
+    m->nrows = 0;
+    m->ncols = 0;
+}
+
+void
+gghlite_enc_mat_set(gghlite_enc_mat_t rop, const gghlite_enc_mat_t op)
+{
+    if (rop == op)
+        return;
+    if (rop->nrows != op->nrows || rop->ncols != op->ncols)
+        ggh_die("cannot set %zu × %zu matrix to %zu × %zu matrix", rop->nrows, rop->ncols, op->nrows, op->ncols);
+    for(size_t k=0; k<op->nrows*op->ncols; k++)
+        fmpz_mod_poly_set(rop->entries[k], op->entries[k]);
+}
+
+/**
+   Make `m` a `nrows × ncols` matrix, entries are kept if the dimensions already match.
+*/
+
+static void
+_gghlite_enc_mat_fit(gghlite_enc_mat_t m, const gghlite_params_t self, const size_t nrows, const size_t ncols)
+{
+    if (m->nrows == nrows && m->ncols == ncols)
+        return;
+    gghlite_enc_mat_clear(m);
+    gghlite_enc_mat_init(m, self, nrows, ncols);
+}
+
+/**
+   Compute $C = A·B$ where `rop` aliases neither input and dimensions were checked.
+*/
+
+static void
+_gghlite_enc_mat_mul(gghlite_enc_mat_t rop, const gghlite_params_t self,
+                     const gghlite_enc_mat_t a, const gghlite_enc_mat_t b)
+{
+    const size_t k = a->ncols;
+    const size_t nrows = rop->nrows;
+    const size_t ncols = rop->ncols;
+
+    /* columns of b as contiguous read-only shallow copies of its entries */
+    fmpz_mod_poly_struct *bt = (fmpz_mod_poly_struct*)malloc((ncols*k + 1) * sizeof(fmpz_mod_poly_struct));
+    if (bt == NULL)
+        ggh_die("failed to allocate %zu encodings", ncols*k);
+    for(size_t j=0; j<ncols; j++)
+        for(size_t l=0; l<k; l++)
+            bt[j*k + l] = *b->entries[l*ncols + j];
+
+    const size_t B = GGHLITE_ENC_MAT_BLOCK;
+    const size_t rtiles = (nrows + B - 1)/B;
+    const size_t ctiles = (ncols + B - 1)/B;
+    const size_t ntiles = rtiles * ctiles;
+
+    /* one tile per thread, the kernels of each tile see an active parallel region and hence run on
+       that thread only, cf. _fmpz_mod_poly_oz_ntt_nthreads */
+    const int nthreads = omp_in_parallel() ? 1 : self->ntt->nthreads;
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads) if(nthreads > 1 && ntiles > 1)
+    for(size_t t=0; t<ntiles; t++) {
+        const size_t i0 = (t / ctiles)*B;
+        const size_t j0 = (t % ctiles)*B;
+        const size_t i1 = (i0 + B < nrows) ? i0 + B : nrows;
+        const size_t j1 = (j0 + B < ncols) ? j0 + B : ncols;
+        for(size_t i=i0; i<i1; i++)
+            for(size_t j=j0; j<j1; j++)
+                gghlite_enc_dot(rop->entries[i*ncols + j], self, a->entries + i*k,
+                                (gghlite_enc_t*)(bt + j*k), k);
+    }
+
+    free(bt);
+}
+
+void
+gghlite_enc_mat_mul(gghlite_enc_mat_t rop, const gghlite_params_t self,
+                    const gghlite_enc_mat_t a, const gghlite_enc_mat_t b)
+{
+    if (a->ncols != b->nrows)
+        ggh_die("cannot multiply %zu × %zu matrix by %zu × %zu matrix", a->nrows, a->ncols, b->nrows, b->ncols);
+    if (rop->nrows != a->nrows || rop->ncols != b->ncols)
+        ggh_die("product of %zu × %zu and %zu × %zu matrix does not fit %zu × %zu matrix",
+                a->nrows, a->ncols, b->nrows, b->ncols, rop->nrows, rop->ncols);
+
+    if (rop == a || rop == b) {
+        gghlite_enc_mat_t t;
+        gghlite_enc_mat_init(t, self, rop->nrows, rop->ncols);
+        _gghlite_enc_mat_mul(t, self, a, b);
+        gghlite_enc_mat_swap(rop, t);
+        gghlite_enc_mat_clear(t);
+    } else {
+        _gghlite_enc_mat_mul(rop, self, a, b);
+    }
+}
+
+void
+gghlite_enc_mat_mul_vec(gghlite_enc_t *rop, const gghlite_params_t self,
+                        const gghlite_enc_mat_t a, gghlite_enc_t *v)
+{
+    const size_t nrows = a->nrows;
+    const size_t ncols = a->ncols;
+    gghlite_enc_t *w = rop;
+
+    if (rop == v) {
+        w = (gghlite_enc_t*)calloc(nrows + 1, sizeof(gghlite_enc_t));
+        if (w == NULL)
+            ggh_die("failed to allocate %zu encodings", nrows);
+        for(size_t i=0; i<nrows; i++)
+            gghlite_enc_init(w[i], self);
+    }
+
+    /* one row per thread, as for tiles above */
+    const int nthreads = omp_in_parallel() ? 1 : self->ntt->nthreads;
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads) if(nthreads > 1 && nrows > 1)
+    for(size_t i=0; i<nrows; i++)
+        gghlite_enc_dot(w[i], self, a->entries + i*ncols, v, ncols);
+
+    if (w != rop) {
+        for(size_t i=0; i<nrows; i++) {
+            fmpz_mod_poly_swap(rop[i], w[i]);
+            gghlite_enc_clear(w[i]);
+        }
+        free(w);
+    }
+}
+
+void
+gghlite_enc_mat_mul_many(gghlite_enc_mat_t rop, const gghlite_params_t self,
+                         gghlite_enc_mat_t *mats, const size_t count)
+{
+    if (count == 0)
+        ggh_die("cannot multiply zero matrices");
+
+    const size_t nrows = mats[0]->nrows;
+    const size_t ncols = mats[count-1]->ncols;
+    if (rop->nrows != nrows || rop->ncols != ncols)
+        ggh_die("product of %zu matrices is %zu × %zu, not %zu × %zu", count, nrows, ncols, rop->nrows, rop->ncols);
+    for(size_t i=1; i<count; i++)
+        if (mats[i-1]->ncols != mats[i]->nrows)
+            ggh_die("cannot multiply %zu × %zu matrix by %zu × %zu matrix",
+                    mats[i-1]->nrows, mats[i-1]->ncols, mats[i]->nrows, mats[i]->ncols);
+
+    if (count == 1) {
+        gghlite_enc_mat_set(rop, mats[0]);
+        return;
+    }
+
+    /* accumulate in t, alternating with u, from whichever end is narrower */
+    const int left = (nrows <= ncols);
+    gghlite_enc_mat_t t, u;
+    if (left) {
+        gghlite_enc_mat_init(t, self, nrows, mats[1]->ncols);
+        _gghlite_enc_mat_mul(t, self, mats[0], mats[1]);
+    } else {
+        gghlite_enc_mat_init(t, self, mats[count-2]->nrows, ncols);
+        _gghlite_enc_mat_mul(t, self, mats[count-2], mats[count-1]);
+    }
+    gghlite_enc_mat_init(u, self, t->nrows, t->ncols);
+
+    for(size_t i=2; i<count; i++) {
+        if (left) {
+            _gghlite_enc_mat_fit(u, self, nrows, mats[i]->ncols);
+            _gghlite_enc_mat_mul(u, self, t, mats[i]);
+        } else {
+            _gghlite_enc_mat_fit(u, self, mats[count-1-i]->nrows, ncols);
+            _gghlite_enc_mat_mul(u, self, mats[count-1-i], t);
+        }
+        gghlite_enc_mat_swap(t, u);
+    }
+
+    gghlite_enc_mat_swap(rop, t);
+    gghlite_enc_mat_clear(t);
+    gghlite_enc_mat_clear(u);
+}
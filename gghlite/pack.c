@@ -0,0 +1,215 @@
+#include <errno.h>
+#include <unistd.h>
+#include "gghlite-internals.h"
+#include "gghlite.h"
+#include "oz/oz.h"
+
+/*
+  Packed encodings are the n coefficients in [0, q) as b = ⌈log₂ q⌉ bits each, coefficient i at
+  bits [i·b, (i+1)·b) of a little-endian bit stream, padded with zero bits to a whole byte. Eight
+  coefficients take exactly b bytes, so ranges starting at multiples of 8 start at byte i·b/8.
+*/
+
+/**
+   Bit streams over a byte buffer, bits are appended to and taken from `acc` lowest first.
+*/
+
+typedef struct {
+    uint8_t *p;
+    mp_limb_t acc;
+    unsigned int nacc;
+} _gghlite_bits_writer_t;
+
+typedef struct {
+    const uint8_t *p;
+    mp_limb_t acc;
+    unsigned int nacc;
+} _gghlite_bits_reader_t;
+
+static inline void
+_gghlite_bits_put(_gghlite_bits_writer_t *s, mp_limb_t v, unsigned int k)
+{
+    while (k) {
+        const unsigned int t = (8 - s->nacc < k) ? 8 - s->nacc : k;
+        s->acc |= (v & ((((mp_limb_t)1) << t) - 1)) << s->nacc;
+        s->nacc += t;
+        v >>= t;
+        k -= t;
+        if (s->nacc == 8) {
+            *s->p++ = (uint8_t)s->acc;
+            s->acc = 0;
+            s->nacc = 0;
+        }
+    }
+}
+
+static inline mp_limb_t
+_gghlite_bits_get(_gghlite_bits_reader_t *s, const unsigned int k)
+{
+    mp_limb_t v = 0;
+    unsigned int got = 0;
+    while (got < k) {
+        if (s->nacc == 0) {
+            s->acc = *s->p++;
+            s->nacc = 8;
+        }
+        const unsigned int t = (s->nacc < k - got) ? s->nacc : k - got;
+        v |= (s->acc & ((((mp_limb_t)1) << t) - 1)) << got;
+        s->acc >>= t;
+        s->nacc -= t;
+        got += t;
+    }
+    return v;
+}
+
+static void
+_gghlite_enc_check_range(const gghlite_params_t self, const size_t start, const size_t count)
+{
+    if (start % 8 || start + count > (size_t)self->n || (count % 8 && start + count != (size_t)self->n))
+        ggh_die("coefficients [%zu, %zu) are not a packable range of %ld coefficients",
+                start, start + count, self->n);
+}
+
+size_t
+gghlite_enc_packed_size_range(const gghlite_params_t self, const size_t count)
+{
+    const size_t b = fmpz_bits(self->q);
+    return (count * b + 7)/8;
+}
+
+void
+gghlite_enc_pack_range(uint8_t *buf, const gghlite_params_t self, const gghlite_enc_t op,
+                       const size_t start, const size_t count)
+{
+    _gghlite_enc_check_range(self, start, count);
+
+    const mp_bitcnt_t b = fmpz_bits(self->q);
+    const mp_size_t l = fmpz_size(self->q);
+    mp_limb_t x[l];
+    _gghlite_bits_writer_t s = {buf, 0, 0};
+    fmpz_t tmp;
+    fmpz_init(tmp);
+
+    for(size_t i=start; i<start+count; i++) {
+        const fmpz *c = (i < (size_t)op->length) ? op->coeffs + i : NULL;
+        /* lazily reduced coefficients, cf. gghlite_enc_add_lazy, do not fit b bits */
+        if (c && (fmpz_sgn(c) < 0 || fmpz_cmp(c, self->q) >= 0)) {
+            fmpz_mod(tmp, c, self->q);
+            c = tmp;
+        }
+        if (c)
+            _fmpz_oz_get_mpn(x, l, c);
+        else
+            mpn_zero(x, l);
+        for(mp_size_t j=0; j<l; j++) {
+            const mp_bitcnt_t k = (b - j*FLINT_BITS < FLINT_BITS) ? b - j*FLINT_BITS : FLINT_BITS;
+            _gghlite_bits_put(&s, x[j], k);
+        }
+    }
+    if (s.nacc)
+        *s.p = (uint8_t)s.acc;
+    fmpz_clear(tmp);
+}
+
+void
+gghlite_enc_unpack_range(gghlite_enc_t rop, const gghlite_params_t self, const uint8_t *buf,
+                         const size_t start, const size_t count)
+{
+    _gghlite_enc_check_range(self, start, count);
+
+    const mp_bitcnt_t b = fmpz_bits(self->q);
+    const mp_size_t l = fmpz_size(self->q);
+    mp_limb_t x[l];
+    mp_limb_t q[l];
+    _fmpz_oz_get_mpn(q, l, self->q);
+    _gghlite_bits_reader_t s = {buf, 0, 0};
+
+    /* coefficients before start which were cut off by normalisation are zero */
+    fmpz_mod_poly_fit_length(rop, start + count);
+    for(size_t i=rop->length; i<start; i++)
+        fmpz_zero(rop->coeffs + i);
+
+    for(size_t i=start; i<start+count; i++) {
+        for(mp_size_t j=0; j<l; j++) {
+            const mp_bitcnt_t k = (b - j*FLINT_BITS < FLINT_BITS) ? b - j*FLINT_BITS : FLINT_BITS;
+            x[j] = _gghlite_bits_get(&s, k);
+        }
+        if (mpn_cmp(x, q, l) >= 0)
+            ggh_die("packed coefficient %zu is not reduced modulo q", i);
+        _fmpz_oz_set_mpn(rop->coeffs + i, x, l);
+    }
+    if (s.acc)
+        ggh_die("packed encoding has non-zero padding");
+
+    if ((size_t)rop->length < start + count)
+        rop->length = start + count;
+    _fmpz_mod_poly_normalise(rop);
+}
+
+size_t
+gghlite_enc_packed_size(const gghlite_params_t self)
+{
+    return gghlite_enc_packed_size_range(self, self->n);
+}
+
+void
+gghlite_enc_pack(uint8_t *buf, const gghlite_params_t self, const gghlite_enc_t op)
+{
+    gghlite_enc_pack_range(buf, self, op, 0, self->n);
+}
+
+void
+gghlite_enc_unpack(gghlite_enc_t rop, const gghlite_params_t self, const uint8_t *buf)
+{
+    fmpz_mod_poly_zero(rop);
+    gghlite_enc_unpack_range(rop, self, buf, 0, self->n);
+}
+
+/* file descriptors, GGHLITE_PACK_CHUNK coefficients at a time */
+
+void
+gghlite_enc_pack_fd(int fd, const gghlite_params_t self, const gghlite_enc_t op)
+{
+    uint8_t *buf = (uint8_t*)malloc(gghlite_enc_packed_size_range(self, GGHLITE_PACK_CHUNK));
+    if (buf == NULL)
+        ggh_die("failed to allocate packing buffer");
+
+    for(size_t start=0; start<(size_t)self->n; start+=GGHLITE_PACK_CHUNK) {
+        const size_t count = (self->n - start < GGHLITE_PACK_CHUNK) ? self->n - start : GGHLITE_PACK_CHUNK;
+        const size_t size = gghlite_enc_packed_size_range(self, count);
+        gghlite_enc_pack_range(buf, self, op, start, count);
+        for(size_t off=0; off<size; ) {
+            const ssize_t r = write(fd, buf + off, size - off);
+            if (r < 0 && errno == EINTR)
+                continue;
+            if (r <= 0)
+                ggh_die("failed to write packed encoding");
+            off += r;
+        }
+    }
+    free(buf);
+}
+
+void
+gghlite_enc_unpack_fd(gghlite_enc_t rop, const gghlite_params_t self, int fd)
+{
+    uint8_t *buf = (uint8_t*)malloc(gghlite_enc_packed_size_range(self, GGHLITE_PACK_CHUNK));
+    if (buf == NULL)
+        ggh_die("failed to allocate packing buffer");
+
+    fmpz_mod_poly_zero(rop);
+    for(size_t start=0; start<(size_t)self->n; start+=GGHLITE_PACK_CHUNK) {
+        const size_t count = (self->n - start < GGHLITE_PACK_CHUNK) ? self->n - start : GGHLITE_PACK_CHUNK;
+        const size_t size = gghlite_enc_packed_size_range(self, count);
+        for(size_t off=0; off<size; ) {
+            const ssize_t r = read(fd, buf + off, size - off);
+            if (r < 0 && errno == EINTR)
+                continue;
+            if (r <= 0)
+                ggh_die("failed to read packed encoding, stream truncated?");
+            off += r;
+        }
+        gghlite_enc_unpack_range(rop, self, buf, start, count);
+    }
+    free(buf);
+}
@@ -0,0 +1,243 @@
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "gghlite-internals.h"
+#include "gghlite.h"
+#include "oz/oz.h"
+
+/*
+  File layout, all integers in native byte order:
+
+  - header, cf. _gghlite_store_header_t, padded to GGHLITE_MAP_ALIGN bytes
+  - q as ℓ limbs, padded to GGHLITE_MAP_ALIGN bytes
+  - records of n·ℓ limbs in Montgomery representation, padded to GGHLITE_MAP_ALIGN bytes each
+  - index of nrecords entries sorted by (program, step, slot), written by gghlite_store_clear
+
+  `index_offset` is zero until the index is written, such stores are rejected by gghlite_store_open.
+*/
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t kind;
+    uint32_t limb_bits;
+    uint32_t byte_order;
+    uint64_t n;
+    uint64_t nlimbs;
+    uint64_t nrecords;
+    uint64_t index_offset;
+} _gghlite_store_header_t;
+
+static size_t
+_gghlite_store_align(const size_t off)
+{
+    return (off + GGHLITE_MAP_ALIGN - 1) / GGHLITE_MAP_ALIGN * GGHLITE_MAP_ALIGN;
+}
+
+static void
+_gghlite_store_write(const int fd, const void *buf, const size_t size)
+{
+    for(size_t off=0; off<size; ) {
+        const ssize_t r = write(fd, (const char*)buf + off, size - off);
+        if (r < 0 && errno == EINTR)
+            continue;
+        if (r <= 0)
+            ggh_die("failed to write %zu bytes to store", size - off);
+        off += r;
+    }
+}
+
+static void
+_gghlite_store_set_sizes(gghlite_store_t self, const gghlite_params_t params)
+{
+    const mp_size_t l = params->ntt->mont->nlimbs;
+    self->params = params;
+    self->record_size = _gghlite_store_align(params->n * l * sizeof(mp_limb_t));
+    self->data_offset = _gghlite_store_align(sizeof(_gghlite_store_header_t)) +
+        _gghlite_store_align(l * sizeof(mp_limb_t));
+}
+
+static int
+_gghlite_store_cmp(const uint32_t program, const uint32_t step, const uint32_t slot,
+                   const gghlite_store_entry_t *e)
+{
+    if (program != e->program)
+        return (program < e->program) ? -1 : 1;
+    if (step != e->step)
+        return (step < e->step) ? -1 : 1;
+    if (slot != e->slot)
+        return (slot < e->slot) ? -1 : 1;
+    return 0;
+}
+
+static int
+_gghlite_store_entry_cmp(const void *a, const void *b)
+{
+    const gghlite_store_entry_t *e = (const gghlite_store_entry_t*)a;
+    return _gghlite_store_cmp(e->program, e->step, e->slot, (const gghlite_store_entry_t*)b);
+}
+
+void
+gghlite_store_create(gghlite_store_t self, const gghlite_params_t params, const char *filename)
+{
+    memset(self, 0, sizeof(struct _gghlite_store_struct));
+    _gghlite_store_set_sizes(self, params);
+
+    self->fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (self->fd < 0)
+        ggh_die("failed to create '%s'", filename);
+
+    const mp_size_t l = params->ntt->mont->nlimbs;
+    const size_t size = self->data_offset;
+    char *buf = (char*)calloc(size, 1);
+    if (buf == NULL)
+        ggh_die("failed to allocate %zu bytes", size);
+
+    _gghlite_store_header_t *header = (_gghlite_store_header_t*)buf;
+    memcpy(header->magic, GGHLITE_FILE_MAGIC, sizeof(header->magic));
+    header->version = GGHLITE_FILE_VERSION;
+    header->kind = _GGHLITE_FILE_STORE;
+    header->limb_bits = FLINT_BITS;
+    header->byte_order = _GGHLITE_FILE_BYTE_ORDER;
+    header->n = params->n;
+    header->nlimbs = l;
+    _fmpz_oz_get_mpn((mp_ptr)(buf + _gghlite_store_align(sizeof(_gghlite_store_header_t))), l, params->q);
+
+    _gghlite_store_write(self->fd, buf, size);
+    free(buf);
+
+    gghlite_enc_mpn_init(self->tmp, params);
+}
+
+void
+gghlite_store_append(gghlite_store_t self, const uint32_t program, const uint32_t step, const uint32_t slot,
+                     const gghlite_enc_t op)
+{
+    if (self->map)
+        ggh_die("cannot append to a mapped store");
+
+    if (self->nrecords == self->index_alloc) {
+        self->index_alloc = (self->index_alloc) ? 2*self->index_alloc : 1024;
+        self->index = (gghlite_store_entry_t*)realloc(self->index, self->index_alloc * sizeof(gghlite_store_entry_t));
+        if (self->index == NULL)
+            ggh_die("failed to allocate %zu index entries", self->index_alloc);
+    }
+    gghlite_store_entry_t *e = self->index + self->nrecords;
+    e->program = program;
+    e->step = step;
+    e->slot = slot;
+    e->reserved = 0;
+    e->record = self->nrecords++;
+
+    const size_t size = self->params->n * self->tmp->nlimbs * sizeof(mp_limb_t);
+    static const char zeros[GGHLITE_MAP_ALIGN];
+    gghlite_enc_mpn_set_gghlite_enc(self->tmp, self->params, op);
+    _gghlite_store_write(self->fd, self->tmp->coeffs, size);
+    _gghlite_store_write(self->fd, zeros, self->record_size - size);
+}
+
+void
+gghlite_store_open(gghlite_store_t self, const gghlite_params_t params, const char *filename)
+{
+    memset(self, 0, sizeof(struct _gghlite_store_struct));
+    _gghlite_store_set_sizes(self, params);
+    self->fd = -1;
+
+    const int fd = open(filename, O_RDONLY);
+    if (fd < 0)
+        ggh_die("failed to open '%s'", filename);
+    struct stat st;
+    if (fstat(fd, &st) || (size_t)st.st_size < self->data_offset) {
+        close(fd);
+        ggh_die("'%s' is not a store", filename);
+    }
+    self->map_size = st.st_size;
+    self->map = mmap(NULL, self->map_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (self->map == MAP_FAILED)
+        ggh_die("failed to map '%s'", filename);
+
+    const _gghlite_store_header_t *header = (const _gghlite_store_header_t*)self->map;
+    const mp_size_t l = params->ntt->mont->nlimbs;
+    if (memcmp(header->magic, GGHLITE_FILE_MAGIC, sizeof(header->magic)) || header->kind != _GGHLITE_FILE_STORE)
+        ggh_die("'%s' is not a store", filename);
+    if (header->version != GGHLITE_FILE_VERSION)
+        ggh_die("unsupported file version %u, expected %u", header->version, GGHLITE_FILE_VERSION);
+    if (header->limb_bits != FLINT_BITS || header->byte_order != _GGHLITE_FILE_BYTE_ORDER)
+        ggh_die("file was written on a machine with %u-bit limbs or a different byte order", header->limb_bits);
+
+    mp_limb_t q[l];
+    _fmpz_oz_get_mpn(q, l, params->q);
+    const mp_srcptr q_ = (mp_srcptr)((const char*)self->map + _gghlite_store_align(sizeof(_gghlite_store_header_t)));
+    if (header->n != (uint64_t)params->n || header->nlimbs != (uint64_t)l || mpn_cmp(q, q_, l))
+        ggh_die("'%s' holds encodings for different params", filename);
+
+    if (header->index_offset == 0)
+        ggh_die("'%s' was not completed by gghlite_store_clear", filename);
+    self->nrecords = header->nrecords;
+    if (header->index_offset != self->data_offset + self->nrecords * self->record_size ||
+        header->index_offset + self->nrecords * sizeof(gghlite_store_entry_t) > self->map_size)
+        ggh_die("'%s' is truncated", filename);
+    self->index = (gghlite_store_entry_t*)((char*)self->map + header->index_offset);
+
+    /* lookups touch few records in no particular order, do not read ahead */
+    madvise(self->map, self->map_size, MADV_RANDOM);
+}
+
+int
+gghlite_store_get(gghlite_enc_mpn_view_t rop, const gghlite_store_t self, const uint32_t program,
+                  const uint32_t step, const uint32_t slot)
+{
+    if (self->map == NULL)
+        ggh_die("store is not mapped");
+
+    size_t lo = 0, hi = self->nrecords;
+    while (lo < hi) {
+        const size_t mid = lo + (hi - lo)/2;
+        const int c = _gghlite_store_cmp(program, step, slot, self->index + mid);
+        if (c == 0) {
+            rop->n = self->params->n;
+            rop->nlimbs = self->params->ntt->mont->nlimbs;
+            rop->coeffs = (mp_srcptr)((const char*)self->map + self->data_offset +
+                                      self->index[mid].record * self->record_size);
+            return 1;
+        }
+        if (c < 0)
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+    return 0;
+}
+
+void
+gghlite_store_clear(gghlite_store_t self)
+{
+    if (self->map) {
+        munmap(self->map, self->map_size);
+        memset(self, 0, sizeof(struct _gghlite_store_struct));
+        return;
+    }
+
+    qsort(self->index, self->nrecords, sizeof(gghlite_store_entry_t), _gghlite_store_entry_cmp);
+    for(size_t i=1; i<self->nrecords; i++)
+        if (_gghlite_store_entry_cmp(self->index + i - 1, self->index + i) == 0)
+            ggh_die("duplicate key (%u, %u, %u) in store", self->index[i].program, self->index[i].step,
+                    self->index[i].slot);
+    _gghlite_store_write(self->fd, self->index, self->nrecords * sizeof(gghlite_store_entry_t));
+
+    /* the header is completed last, an interrupted write leaves a store which is rejected */
+    const uint64_t tail[2] = {self->nrecords, self->data_offset + self->nrecords * self->record_size};
+    if (pwrite(self->fd, tail, sizeof(tail), offsetof(_gghlite_store_header_t, nrecords)) != sizeof(tail))
+        ggh_die("failed to write store header");
+    if (close(self->fd))
+        ggh_die("failed to close store");
+
+    free(self->index);
+    gghlite_enc_mpn_clear(self->tmp);
+    memset(self, 0, sizeof(struct _gghlite_store_struct));
+}
@@ -11,7 +11,9 @@
 */
 
 typedef enum {
-  OZ_VERBOSE    = 0x1, //!< print debug messages
+  OZ_VERBOSE     = 0x1, //!< print debug messages
+  OZ_NTT_COMPACT = 0x2, //!< do not store the power tables `w` and `phi` of NTT pre-computations
+  OZ_NTT_SEEDED  = 0x4, //!< regenerate NTT twiddle factors from seed tables of size $O(\\sqrt{n})$
 } oz_flag_t;
 
 #endif /* _FLAGS_H */
@@ -0,0 +1,48 @@
+#include <assert.h>
+#include "mont.h"
+#include "util.h"
+
+void fmpz_oz_mont_init(fmpz_oz_mont_t op, const fmpz_t q) {
+  if (fmpz_cmp_ui(q, 1) <= 0 || fmpz_is_even(q))
+    oz_die("Montgomery arithmetic requires an odd modulus q > 1");
+
+  const mp_size_t n = fmpz_size(q);
+  op->nlimbs = n;
+  op->q  = (mp_ptr)malloc(n * sizeof(mp_limb_t));
+  op->r2 = (mp_ptr)malloc(n * sizeof(mp_limb_t));
+  _fmpz_oz_get_mpn(op->q, n, q);
+
+  /* Newton iteration for q^{-1} mod 2^w, q_0·q_0 = 1 mod 8 gives three correct bits to start */
+  const mp_limb_t q0 = op->q[0];
+  mp_limb_t inv = q0;
+  for(size_t i=0; i<6; i++)
+    inv *= 2 - q0 * inv;
+  assert(inv * q0 == 1);
+  op->q_inv = -inv;
+
+  fmpz_t r2;  fmpz_init_set_ui(r2, 1);
+  fmpz_mul_2exp(r2, r2, 2 * FLINT_BITS * n);
+  fmpz_mod(r2, r2, q);
+  _fmpz_oz_get_mpn(op->r2, n, r2);
+  fmpz_clear(r2);
+}
+
+void fmpz_oz_mont_clear(fmpz_oz_mont_t op) {
+  free(op->q);
+  free(op->r2);
+}
+
+void _fmpz_oz_mont_redc(mp_ptr rop, mp_ptr t, const fmpz_oz_mont_t mont) {
+  const mp_size_t n = mont->nlimbs;
+
+  /* the carry out of row i belongs at position n+i, we park it in t[i] which was just cleared */
+  mp_ptr u = t;
+  for(mp_size_t i=0; i<n; i++) {
+    const mp_limb_t m = u[0] * mont->q_inv;
+    u[0] = mpn_addmul_1(u, mont->q, n, m);
+    u++;
+  }
+  const mp_limb_t cy = mpn_add_n(rop, u, t, n);
+  if (cy || mpn_cmp(rop, mont->q, n) >= 0)
+    mpn_sub_n(rop, rop, mont->q, n);
+}
@@ -0,0 +1,156 @@
+/**
+   @file mont.h
+   @brief Fixed-width Montgomery arithmetic modulo an odd multi-limb modulus.
+
+   Let $q$ be odd with $\\ell$ limbs and let @f$R = 2^{\ell·w}@f$ where $w$ is the limb size in
+   bits. Montgomery multiplication computes @f$a·b·R^{-1} \bmod q@f$ using only multiplications and
+   additions of limbs, i.e. without any division. Elements are stored as exactly $\\ell$ limbs in
+   $[0, q)$. All functions starting with an underscore operate on such limb vectors and neither
+   allocate memory nor divide.
+*/
+
+#ifndef MONT_H
+#define MONT_H
+
+#include <stdint.h>
+#include <gmp.h>
+#include <flint/flint.h>
+#include <flint/fmpz.h>
+
+/**
+   @brief Pre-computed data for Montgomery arithmetic modulo $q$.
+*/
+
+struct fmpz_oz_mont_struct {
+  mp_size_t nlimbs;   //!< number of limbs $\\ell$ of $q$
+  mp_ptr q;           //!< modulus $q$ as $\\ell$ limbs
+  mp_limb_t q_inv;    //!< $-q^{-1} \\bmod 2^w$
+  mp_ptr r2;          //!< @f$R^2 \bmod q@f$ as $\\ell$ limbs
+};
+
+typedef struct fmpz_oz_mont_struct fmpz_oz_mont_t[1];
+
+/**
+   @brief Pre-compute Montgomery data for odd $q > 1$.
+*/
+
+void fmpz_oz_mont_init(fmpz_oz_mont_t op, const fmpz_t q);
+
+/**
+   @brief Clear Montgomery data.
+*/
+
+void fmpz_oz_mont_clear(fmpz_oz_mont_t op);
+
+/**
+   @brief Write $0 ≤ \\mbox{op} < 2^{wn}$ to `n` limbs at `rop`.
+*/
+
+static inline void _fmpz_oz_get_mpn(mp_ptr rop, const mp_size_t n, const fmpz_t op) {
+  if (!COEFF_IS_MPZ(*op)) {
+    rop[0] = (mp_limb_t)*op;
+    mpn_zero(rop + 1, n - 1);
+  } else {
+    const __mpz_struct *z = COEFF_TO_PTR(*op);
+    const mp_size_t s = z->_mp_size;
+    mpn_copyi(rop, z->_mp_d, s);
+    mpn_zero(rop + s, n - s);
+  }
+}
+
+/**
+   @brief Set `rop` to the integer represented by `n` limbs at `op`.
+
+   @note Only allocates if `rop` does not have space for $n$ limbs yet.
+*/
+
+static inline void _fmpz_oz_set_mpn(fmpz_t rop, mp_srcptr op, mp_size_t n) {
+  while (n > 0 && op[n-1] == 0)
+    n--;
+  if (n <= 1) {
+    fmpz_set_ui(rop, n ? op[0] : 0);
+  } else {
+    __mpz_struct *z = _fmpz_promote(rop);
+    if (z->_mp_alloc < n)
+      mpz_realloc2(z, n * FLINT_BITS);
+    mpn_copyi(z->_mp_d, op, n);
+    z->_mp_size = n;
+  }
+}
+
+/**
+   @brief Compute @f$\mbox{rop} = t·R^{-1} \bmod q@f$ for @f$0 ≤ t < q·R@f$.
+
+   @param rop  $\\ell$ limbs, may alias the upper half of `t`
+   @param t    $2\\ell$ limbs, destroyed
+*/
+
+void _fmpz_oz_mont_redc(mp_ptr rop, mp_ptr t, const fmpz_oz_mont_t mont);
+
+/**
+   @brief Compute @f$\mbox{rop} = a·b·R^{-1} \bmod q@f$.
+
+   @param rop  $\\ell$ limbs, may alias `a` or `b`
+   @param t    scratch space of $2\\ell$ limbs, must not overlap any other argument
+*/
+
+static inline void _fmpz_oz_mont_mul(mp_ptr rop, mp_srcptr a, mp_srcptr b, mp_ptr t, const fmpz_oz_mont_t mont) {
+  if (a == b)
+    mpn_sqr(t, a, mont->nlimbs);
+  else
+    mpn_mul_n(t, a, b, mont->nlimbs);
+  _fmpz_oz_mont_redc(rop, t, mont);
+}
+
+/**
+   @brief Compute @f$\mbox{rop} = a·b \bmod q@f$ for $a,b$ not in Montgomery representation.
+
+   @param t    scratch space of $2\\ell$ limbs, must not overlap any other argument
+*/
+
+static inline void _fmpz_oz_mont_mulmod(mp_ptr rop, mp_srcptr a, mp_srcptr b, mp_ptr t, const fmpz_oz_mont_t mont) {
+  _fmpz_oz_mont_mul(rop, a, b, t, mont);
+  _fmpz_oz_mont_mul(rop, rop, mont->r2, t, mont);
+}
+
+/**
+   @brief Compute @f$\mbox{rop} = a·R \bmod q@f$, i.e. convert to Montgomery representation.
+*/
+
+static inline void _fmpz_oz_mont_set(mp_ptr rop, mp_srcptr a, mp_ptr t, const fmpz_oz_mont_t mont) {
+  _fmpz_oz_mont_mul(rop, a, mont->r2, t, mont);
+}
+
+/**
+   @brief Compute @f$\mbox{rop} = a·R^{-1} \bmod q@f$, i.e. convert from Montgomery representation.
+*/
+
+static inline void _fmpz_oz_mont_get(mp_ptr rop, mp_srcptr a, mp_ptr t, const fmpz_oz_mont_t mont) {
+  const mp_size_t n = mont->nlimbs;
+  mpn_copyi(t, a, n);
+  mpn_zero(t + n, n);
+  _fmpz_oz_mont_redc(rop, t, mont);
+}
+
+/**
+   @brief Compute @f$\mbox{rop} = a + b \bmod q@f$.
+*/
+
+static inline void _fmpz_oz_mont_add(mp_ptr rop, mp_srcptr a, mp_srcptr b, const fmpz_oz_mont_t mont) {
+  const mp_size_t n = mont->nlimbs;
+  const mp_limb_t cy = mpn_add_n(rop, a, b, n);
+  if (cy || mpn_cmp(rop, mont->q, n) >= 0)
+    mpn_sub_n(rop, rop, mont->q, n);
+}
+
+/**
+   @brief Compute @f$\mbox{rop} = a - b \bmod q@f$.
+*/
+
+static inline void _fmpz_oz_mont_sub(mp_ptr rop, mp_srcptr a, mp_srcptr b, const fmpz_oz_mont_t mont) {
+  const mp_size_t n = mont->nlimbs;
+  if (mpn_sub_n(rop, a, b, n))
+    mpn_add_n(rop, rop, mont->q, n);
+}
+
+#endif /* MONT_H */
@@ -0,0 +1,101 @@
+#include <assert.h>
+#include <stdlib.h>
+#include "mpn.h"
+#include "util.h"
+
+void fmpz_mod_poly_oz_mpn_init(fmpz_mod_poly_oz_mpn_t op, const fmpz_mod_poly_oz_ntt_precomp_t precomp) {
+  op->n = precomp->n;
+  op->nlimbs = precomp->mont->nlimbs;
+  void *buf = NULL;
+  if (posix_memalign(&buf, OZ_MPN_ALIGN, op->n * op->nlimbs * sizeof(mp_limb_t)))
+    oz_die("failed to allocate %zu limbs", op->n * op->nlimbs);
+  op->coeffs = (mp_ptr)buf;
+  fmpz_mod_poly_oz_mpn_zero(op);
+}
+
+void fmpz_mod_poly_oz_mpn_clear(fmpz_mod_poly_oz_mpn_t op) {
+  free(op->coeffs);
+}
+
+void fmpz_mod_poly_oz_mpn_set_fmpz_mod_poly(fmpz_mod_poly_oz_mpn_t rop, const fmpz_mod_poly_t op,
+                                            const fmpz_mod_poly_oz_ntt_precomp_t precomp) {
+  const mp_size_t l = rop->nlimbs;
+  const fmpz *q = fmpz_mod_poly_modulus(precomp->phi);
+  mp_limb_t t[2*l];
+  fmpz_t tmp;
+  fmpz_init(tmp);
+
+  for(size_t i=0; i<rop->n; i++) {
+    mp_ptr r = rop->coeffs + i*l;
+    const fmpz *c = (i < (size_t)op->length) ? op->coeffs + i : NULL;
+    if (c && !fmpz_is_zero(c)) {
+      /* lazily reduced or negative coefficients do not fit l limbs as they are */
+      if (fmpz_sgn(c) < 0 || fmpz_cmp(c, q) >= 0) {
+        fmpz_mod(tmp, c, q);
+        c = tmp;
+      }
+      _fmpz_oz_get_mpn(r, l, c);
+      _fmpz_oz_mont_set(r, r, t, precomp->mont);
+    } else {
+      mpn_zero(r, l);
+    }
+  }
+  fmpz_clear(tmp);
+}
+
+void fmpz_mod_poly_oz_mpn_get_fmpz_mod_poly(fmpz_mod_poly_t rop, const fmpz_mod_poly_oz_mpn_view_t op,
+                                            const fmpz_mod_poly_oz_ntt_precomp_t precomp) {
+  const mp_size_t l = op->nlimbs;
+  mp_limb_t t[2*l];
+  mp_limb_t x[l];
+
+  fmpz_mod_poly_realloc(rop, op->n);
+  for(size_t i=0; i<op->n; i++) {
+    _fmpz_oz_mont_get(x, op->coeffs + i*l, t, precomp->mont);
+    _fmpz_oz_set_mpn(rop->coeffs + i, x, l);
+  }
+  rop->length = op->n;
+}
+
+void fmpz_mod_poly_oz_mpn_ntt_enc(fmpz_mod_poly_oz_mpn_t rop, const fmpz_mod_poly_oz_mpn_view_t op,
+                                  const fmpz_mod_poly_oz_ntt_precomp_t precomp) {
+  fmpz_mod_poly_oz_mpn_set(rop, op);
+  _mpn_oz_ntt_enc(rop->coeffs, precomp);
+}
+
+void fmpz_mod_poly_oz_mpn_ntt_dec(fmpz_mod_poly_oz_mpn_t rop, const fmpz_mod_poly_oz_mpn_view_t op,
+                                  const fmpz_mod_poly_oz_ntt_precomp_t precomp) {
+  fmpz_mod_poly_oz_mpn_set(rop, op);
+  _mpn_oz_ntt_dec(rop->coeffs, precomp);
+}
+
+void fmpz_mod_poly_oz_mpn_mul(fmpz_mod_poly_oz_mpn_t h, const fmpz_mod_poly_oz_mpn_view_t f, const fmpz_mod_poly_oz_mpn_view_t g,
+                              const fmpz_mod_poly_oz_ntt_precomp_t precomp) {
+  const mp_size_t l = h->nlimbs;
+  const int nthreads = _fmpz_mod_poly_oz_ntt_nthreads(precomp);
+#pragma omp parallel num_threads(nthreads) if(nthreads > 1)
+  {
+    mp_limb_t t[2*l];
+#pragma omp for
+    for(size_t i=0; i<h->n; i++)
+      _fmpz_oz_mont_mul(h->coeffs + i*l, f->coeffs + i*l, g->coeffs + i*l, t, precomp->mont);
+  }
+}
+
+void fmpz_mod_poly_oz_mpn_add(fmpz_mod_poly_oz_mpn_t h, const fmpz_mod_poly_oz_mpn_view_t f, const fmpz_mod_poly_oz_mpn_view_t g,
+                              const fmpz_mod_poly_oz_ntt_precomp_t precomp) {
+  const mp_size_t l = h->nlimbs;
+  const int nthreads = _fmpz_mod_poly_oz_ntt_nthreads(precomp);
+#pragma omp parallel for num_threads(nthreads) if(nthreads > 1)
+  for(size_t i=0; i<h->n; i++)
+    _fmpz_oz_mont_add(h->coeffs + i*l, f->coeffs + i*l, g->coeffs + i*l, precomp->mont);
+}
+
+void fmpz_mod_poly_oz_mpn_sub(fmpz_mod_poly_oz_mpn_t h, const fmpz_mod_poly_oz_mpn_view_t f, const fmpz_mod_poly_oz_mpn_view_t g,
+                              const fmpz_mod_poly_oz_ntt_precomp_t precomp) {
+  const mp_size_t l = h->nlimbs;
+  const int nthreads = _fmpz_mod_poly_oz_ntt_nthreads(precomp);
+#pragma omp parallel for num_threads(nthreads) if(nthreads > 1)
+  for(size_t i=0; i<h->n; i++)
+    _fmpz_oz_mont_sub(h->coeffs + i*l, f->coeffs + i*l, g->coeffs + i*l, precomp->mont);
+}
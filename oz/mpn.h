@@ -0,0 +1,158 @@
+/**
+   @file mpn.h
+   @brief Elements of @f$\ZZ_q[x]/\ideal{x^n+1}@f$ as one contiguous block of limbs.
+
+   A `fmpz_mod_poly_t` holds $n$ separate `fmpz` coefficients, each of which is a separately
+   allocated `mpz` when $q$ is large. Here all $n$ coefficients are stored as exactly @f$\ell =
+   \lceil \log_2 q / w \rceil@f$ limbs each in one aligned block: coefficient $i$ occupies limbs
+   $i·\\ell, …, (i+1)·\\ell-1$. Coefficients are kept in Montgomery representation @f$a·R \bmod
+   q@f$, cf. @ref mont.h, so that a product costs one multiplication and one reduction and zero is
+   represented by zero limbs. Copying an element is a single `memcpy`.
+
+   All functions take the NTT pre-computation for $q$ which provides the Montgomery data.
+*/
+
+#ifndef MPN_H
+#define MPN_H
+
+#include <stdint.h>
+#include <string.h>
+#include <flint/fmpz_poly.h>
+#include <flint/fmpz_mod_poly.h>
+#include <oz/mont.h>
+#include <oz/ntt.h>
+
+/**
+   @brief Alignment of limb blocks in bytes.
+*/
+
+#define OZ_MPN_ALIGN 64
+
+/**
+   @brief A read-only element of @f$\ZZ_q[x]/\ideal{x^n+1}@f$ stored as $n·\\ell$ contiguous limbs.
+
+   Views do not own their limbs, e.g. they may point into a read-only mapping, and are only ever
+   passed as inputs. Use the `view` member of @ref fmpz_mod_poly_oz_mpn_t to pass an owned element.
+*/
+
+struct fmpz_mod_poly_oz_mpn_view_struct {
+  mp_srcptr coeffs;   //!< $n·\\ell$ limbs, coefficient $i$ in Montgomery representation at limbs $i·\\ell, …$
+  size_t n;           //!< dimension
+  mp_size_t nlimbs;   //!< number of limbs $\\ell$ per coefficient
+};
+
+typedef struct fmpz_mod_poly_oz_mpn_view_struct fmpz_mod_poly_oz_mpn_view_t[1];
+
+/**
+   @brief An element of @f$\ZZ_q[x]/\ideal{x^n+1}@f$ stored as $n·\\ell$ contiguous limbs it owns.
+*/
+
+struct fmpz_mod_poly_oz_mpn_struct {
+  union {
+    struct {
+      mp_ptr coeffs;      //!< $n·\\ell$ limbs, coefficient $i$ in Montgomery representation at limbs $i·\\ell, …$
+      size_t n;           //!< dimension
+      mp_size_t nlimbs;   //!< number of limbs $\\ell$ per coefficient
+    };
+    fmpz_mod_poly_oz_mpn_view_t view; //!< the same fields as a read-only view, for passing as input
+  };
+};
+
+typedef struct fmpz_mod_poly_oz_mpn_struct fmpz_mod_poly_oz_mpn_t[1];
+
+/**
+   @brief Initialise `op` to zero.
+*/
+
+void fmpz_mod_poly_oz_mpn_init(fmpz_mod_poly_oz_mpn_t op, const fmpz_mod_poly_oz_ntt_precomp_t precomp);
+
+/**
+   @brief Clear `op`.
+*/
+
+void fmpz_mod_poly_oz_mpn_clear(fmpz_mod_poly_oz_mpn_t op);
+
+/**
+   @brief Set `rop` to `op`.
+*/
+
+static inline void fmpz_mod_poly_oz_mpn_set(fmpz_mod_poly_oz_mpn_t rop, const fmpz_mod_poly_oz_mpn_view_t op) {
+  if (rop->coeffs != op->coeffs)
+    memcpy(rop->coeffs, op->coeffs, op->n * op->nlimbs * sizeof(mp_limb_t));
+}
+
+/**
+   @brief Set `op` to zero.
+*/
+
+static inline void fmpz_mod_poly_oz_mpn_zero(fmpz_mod_poly_oz_mpn_t op) {
+  memset(op->coeffs, 0, op->n * op->nlimbs * sizeof(mp_limb_t));
+}
+
+/**
+   @brief Return 1 if all coefficients of `op` are zero.
+*/
+
+static inline int fmpz_mod_poly_oz_mpn_is_zero(const fmpz_mod_poly_oz_mpn_view_t op) {
+  const size_t len = op->n * op->nlimbs;
+  for(size_t i=0; i<len; i++)
+    if (op->coeffs[i])
+      return 0;
+  return 1;
+}
+
+/**
+   @brief Set `rop` to `op`, coefficient by coefficient.
+
+   The domain is not changed, i.e. if `op` is in the NTT domain then so is `rop`. Coefficients of
+   `op` outside $[0,q)$ are reduced first.
+*/
+
+void fmpz_mod_poly_oz_mpn_set_fmpz_mod_poly(fmpz_mod_poly_oz_mpn_t rop, const fmpz_mod_poly_t op,
+                                            const fmpz_mod_poly_oz_ntt_precomp_t precomp);
+
+/**
+   @brief Set `rop` to `op`, coefficient by coefficient.
+
+   The domain is not changed, i.e. if `op` is in the NTT domain then so is `rop`.
+*/
+
+void fmpz_mod_poly_oz_mpn_get_fmpz_mod_poly(fmpz_mod_poly_t rop, const fmpz_mod_poly_oz_mpn_view_t op,
+                                            const fmpz_mod_poly_oz_ntt_precomp_t precomp);
+
+/**
+   @brief Compute @f$\mbox{rop} = \NTT{\mbox{op}}@f$.
+*/
+
+void fmpz_mod_poly_oz_mpn_ntt_enc(fmpz_mod_poly_oz_mpn_t rop, const fmpz_mod_poly_oz_mpn_view_t op,
+                                  const fmpz_mod_poly_oz_ntt_precomp_t precomp);
+
+/**
+   @brief Compute @f$\mbox{rop} = \INTT{\mbox{op}}@f$.
+*/
+
+void fmpz_mod_poly_oz_mpn_ntt_dec(fmpz_mod_poly_oz_mpn_t rop, const fmpz_mod_poly_oz_mpn_view_t op,
+                                  const fmpz_mod_poly_oz_ntt_precomp_t precomp);
+
+/**
+   @brief Compute $h = f·g$ coefficient-wise, i.e. a product in the NTT domain.
+*/
+
+void fmpz_mod_poly_oz_mpn_mul(fmpz_mod_poly_oz_mpn_t h, const fmpz_mod_poly_oz_mpn_view_t f, const fmpz_mod_poly_oz_mpn_view_t g,
+                              const fmpz_mod_poly_oz_ntt_precomp_t precomp);
+
+/**
+   @brief Compute $h = f+g$.
+*/
+
+void fmpz_mod_poly_oz_mpn_add(fmpz_mod_poly_oz_mpn_t h, const fmpz_mod_poly_oz_mpn_view_t f, const fmpz_mod_poly_oz_mpn_view_t g,
+                              const fmpz_mod_poly_oz_ntt_precomp_t precomp);
+
+/**
+   @brief Compute $h = f-g$.
+*/
+
+void fmpz_mod_poly_oz_mpn_sub(fmpz_mod_poly_oz_mpn_t h, const fmpz_mod_poly_oz_mpn_view_t f, const fmpz_mod_poly_oz_mpn_view_t g,
+                              const fmpz_mod_poly_oz_ntt_precomp_t precomp);
+
+#endif /* MPN_H */
@@ -1,6 +1,8 @@
 #include <assert.h>
+#include <omp.h>
 #include "ntt.h"
 #include "util.h"
+#include "norm.h"
 
 static int _fmpz_nth_root(fmpz_t rop, const long n, const fmpz_t q) {
   if (fmpz_cmp_si(q, 2) == 0) {
@@ -62,7 +64,13 @@ static void fmpz_mod_poly_oz_set_powers(fmpz_mod_poly_t op, const size_t n, cons
   fmpz_clear(acc);
 }
 
-void _fmpz_mod_poly_oz_ntt(fmpz_mod_poly_t rop, const fmpz_mod_poly_t op, const fmpz_mod_poly_t w, const size_t n) {
+/**
+   Radix-2 transform using the powers of $ω_n$ in `w`. If `inv` is set, $ω_n^{-i} = ω_n^{n-i}$ is
+   used instead of $ω_n^i$.
+*/
+
+static void _fmpz_mod_poly_oz_ntt_w(fmpz_mod_poly_t rop, const fmpz_mod_poly_t op, const fmpz_mod_poly_t w,
+                                    const int inv, const size_t n) {
   if (n == 1) {
     fmpz_mod_poly_set(rop, op);
     return;
@@ -85,12 +93,12 @@ void _fmpz_mod_poly_oz_ntt(fmpz_mod_poly_t rop, const fmpz_mod_poly_t op, const
   fmpz *b_hdl = b->coeffs;
 
   for(size_t i=0; i<k; i++) {
-/* #pragma omp parallel for */
+#pragma omp parallel for
     for(size_t j=0; j<n/2; j++) {
       fmpz_t tmp;  fmpz_init(tmp);
       const size_t tk  = (1UL<<(k-1-i));
       const size_t pij = (j/tk) * tk;
-      fmpz_mul(tmp, a_hdl + 2*j+1, w->coeffs + pij);
+      fmpz_mul(tmp, a_hdl + 2*j+1, w->coeffs + ((inv && pij) ? n - pij : pij));
       if(pij)
         fmpz_mod(tmp, tmp, q);
       fmpz_add(b_hdl + j,       a_hdl + 2*j, tmp);
@@ -114,8 +122,368 @@ void _fmpz_mod_poly_oz_ntt(fmpz_mod_poly_t rop, const fmpz_mod_poly_t op, const
   fmpz_mod_poly_clear(a);
 }
 
+void _fmpz_mod_poly_oz_ntt(fmpz_mod_poly_t rop, const fmpz_mod_poly_t op, const fmpz_mod_poly_t w, const size_t n) {
+  _fmpz_mod_poly_oz_ntt_w(rop, op, w, 0, n);
+}
+
+/**
+   Return the number of butterflies per block, cf. `OZ_NTT_BLOCK_BYTES`.
+*/
+
+static inline size_t _mpn_oz_ntt_block(const mp_size_t l) {
+  const size_t b = OZ_NTT_BLOCK_BYTES / (2 * l * sizeof(mp_limb_t));
+  return b ? b : 1;
+}
+
+/**
+   Return $φ^{\mbox{rev}(j)}·R \bmod q$. If the twiddle factors are not stored, they are computed
+   in `u` from the seed tables using `t` of $2\ell$ limbs as scratch space.
+*/
+
+static inline mp_srcptr _mpn_oz_ntt_twiddle(mp_ptr u, const size_t j, mp_ptr t,
+                                            const fmpz_mod_poly_oz_ntt_precomp_t precomp) {
+  const mp_size_t l = precomp->mont->nlimbs;
+  if (precomp->phi_rev_mont)
+    return precomp->phi_rev_mont + j*l;
+
+  const size_t b = precomp->seed_bits;
+  const size_t e = n_revbin(j, n_flog(precomp->n, 2));
+  const size_t e0 = e & ((((size_t)1) << b) - 1);
+  const size_t e1 = e >> b;
+  mp_srcptr c0 = precomp->phi_seed_mont + e0*l;
+  mp_srcptr c1 = precomp->phi_seed_mont + ((((size_t)1) << b) + e1)*l;
+  if (e1 == 0)
+    return c0;
+  if (e0 == 0)
+    return c1;
+  _fmpz_oz_mont_mul(u, c0, c1, t, precomp->mont);
+  return u;
+}
+
+/*
+  Four-step transforms. View `a` as an n1 × n2 matrix in row-major order. The first log n1 stages
+  of the forward transform only combine entries of the same column and use the same twiddles for
+  every column. The remaining stages only combine entries of the same row and the twiddles of row
+  r are those of blocks r·M/n1, … of the full stage with M blocks. Hence, computing all column
+  stages on a few columns at a time and then all row stages one row at a time computes the same
+  result as the radix-2 loop but with two passes over memory instead of log n. The inverse runs
+  the same steps in reverse order.
+*/
+
+static void _mpn_oz_ntt_enc_cols(mp_ptr a, const size_t c0, const size_t c1, const size_t n1, mp_ptr t,
+                                 const fmpz_mod_poly_oz_ntt_precomp_t precomp) {
+  const size_t n = precomp->n;
+  const size_t n2 = n/n1;
+  const mp_size_t l = precomp->mont->nlimbs;
+  mp_ptr v = t + 2*l;
+  mp_ptr u = t + 3*l;
+
+  for(size_t M=1, s=n/2; M<n1; M*=2, s/=2) {
+    for(size_t i=0; i<M; i++) {
+      mp_srcptr c = _mpn_oz_ntt_twiddle(u, M+i, t, precomp);
+      for(size_t jh=0; jh<s; jh+=n2) {
+        mp_ptr x = a + (2*i*s + jh + c0)*l;
+        mp_ptr y = x + s*l;
+        for(size_t j=c0; j<c1; j++, x+=l, y+=l) {
+          _fmpz_oz_mont_mul(v, y, c, t, precomp->mont);
+          _fmpz_oz_mont_sub(y, x, v, precomp->mont);
+          _fmpz_oz_mont_add(x, x, v, precomp->mont);
+        }
+      }
+    }
+  }
+}
+
+static void _mpn_oz_ntt_enc_row(mp_ptr a, const size_t r, const size_t n1, mp_ptr t,
+                                const fmpz_mod_poly_oz_ntt_precomp_t precomp) {
+  const size_t n2 = precomp->n/n1;
+  const mp_size_t l = precomp->mont->nlimbs;
+  mp_ptr v = t + 2*l;
+  mp_ptr u = t + 3*l;
+  mp_ptr row = a + r*n2*l;
+
+  for(size_t M=n1, s=n2/2; s>=1; M*=2, s/=2) {
+    for(size_t i=0; i<n2/(2*s); i++) {
+      mp_srcptr c = _mpn_oz_ntt_twiddle(u, M + r*(M/n1) + i, t, precomp);
+      mp_ptr x = row + 2*i*s*l;
+      mp_ptr y = x + s*l;
+      for(size_t j=0; j<s; j++, x+=l, y+=l) {
+        _fmpz_oz_mont_mul(v, y, c, t, precomp->mont);
+        _fmpz_oz_mont_sub(y, x, v, precomp->mont);
+        _fmpz_oz_mont_add(x, x, v, precomp->mont);
+      }
+    }
+  }
+}
+
+static void _mpn_oz_ntt_dec_row(mp_ptr a, const size_t r, const size_t n1, mp_ptr t,
+                                const fmpz_mod_poly_oz_ntt_precomp_t precomp) {
+  const size_t n2 = precomp->n/n1;
+  const mp_size_t l = precomp->mont->nlimbs;
+  mp_ptr v = t + 2*l;
+  mp_ptr u = t + 3*l;
+  mp_ptr row = a + r*n2*l;
+
+  /* (x - y)·φ^{-rev(M+i)} = (y - x)·φ^{rev(2M-1-i)} */
+  for(size_t M=precomp->n/2, s=1; M>=n1; M/=2, s*=2) {
+    for(size_t i=0; i<n2/(2*s); i++) {
+      mp_srcptr c = _mpn_oz_ntt_twiddle(u, 2*M-1 - (r*(M/n1) + i), t, precomp);
+      mp_ptr x = row + 2*i*s*l;
+      mp_ptr y = x + s*l;
+      for(size_t j=0; j<s; j++, x+=l, y+=l) {
+        _fmpz_oz_mont_sub(v, y, x, precomp->mont);
+        _fmpz_oz_mont_add(x, x, y, precomp->mont);
+        _fmpz_oz_mont_mul(y, v, c, t, precomp->mont);
+      }
+    }
+  }
+}
+
+static void _mpn_oz_ntt_dec_cols(mp_ptr a, const size_t c0, const size_t c1, const size_t n1, mp_ptr t,
+                                 const fmpz_mod_poly_oz_ntt_precomp_t precomp) {
+  const size_t n = precomp->n;
+  const size_t n2 = n/n1;
+  const mp_size_t l = precomp->mont->nlimbs;
+  mp_ptr v = t + 2*l;
+  mp_ptr u = t + 3*l;
+
+  for(size_t M=n1/2, s=n2; M>1; M/=2, s*=2) {
+    for(size_t i=0; i<M; i++) {
+      mp_srcptr c = _mpn_oz_ntt_twiddle(u, 2*M-1 - i, t, precomp);
+      for(size_t jh=0; jh<s; jh+=n2) {
+        mp_ptr x = a + (2*i*s + jh + c0)*l;
+        mp_ptr y = x + s*l;
+        for(size_t j=c0; j<c1; j++, x+=l, y+=l) {
+          _fmpz_oz_mont_sub(v, y, x, precomp->mont);
+          _fmpz_oz_mont_add(x, x, y, precomp->mont);
+          _fmpz_oz_mont_mul(y, v, c, t, precomp->mont);
+        }
+      }
+    }
+  }
+
+  /* last stage, 1/n is folded into both twiddles */
+  mp_srcptr e0 = precomp->n_inv_mont;
+  mp_srcptr e1 = precomp->n_inv_mont + l;
+  for(size_t jh=0; jh<n/2; jh+=n2) {
+    mp_ptr x = a + (jh + c0)*l;
+    mp_ptr y = x + (n/2)*l;
+    for(size_t j=c0; j<c1; j++, x+=l, y+=l) {
+      _fmpz_oz_mont_sub(v, x, y, precomp->mont);
+      _fmpz_oz_mont_add(x, x, y, precomp->mont);
+      _fmpz_oz_mont_mul(x, x, e0, t, precomp->mont);
+      _fmpz_oz_mont_mul(y, v, e1, t, precomp->mont);
+    }
+  }
+}
+
+/**
+   Return the number of rows $n_1$ and the number of columns processed together.
+*/
+
+static inline size_t _mpn_oz_ntt_four_step_shape(size_t *w, const fmpz_mod_poly_oz_ntt_precomp_t precomp) {
+  const size_t n = precomp->n;
+  const size_t bytes = precomp->mont->nlimbs * sizeof(mp_limb_t);
+  const size_t n1 = ((size_t)1) << (n_flog(n, 2) / 2);
+  *w = OZ_NTT_CACHE_BYTES / (n1 * bytes);
+  if (*w < 1)
+    *w = 1;
+  if (*w > n/n1)
+    *w = n/n1;
+  return n1;
+}
+
+static void _mpn_oz_ntt_enc_four_step(mp_ptr a, const fmpz_mod_poly_oz_ntt_precomp_t precomp) {
+  const mp_size_t l = precomp->mont->nlimbs;
+  size_t w;
+  const size_t n1 = _mpn_oz_ntt_four_step_shape(&w, precomp);
+  const size_t n2 = precomp->n/n1;
+  const int nthreads = _fmpz_mod_poly_oz_ntt_nthreads(precomp);
+
+#pragma omp parallel num_threads(nthreads) if(nthreads > 1)
+  {
+    mp_limb_t t[4*l];
+#pragma omp for schedule(static)
+    for(size_t c0=0; c0<n2; c0+=w)
+      _mpn_oz_ntt_enc_cols(a, c0, (c0+w < n2) ? c0+w : n2, n1, t, precomp);
+#pragma omp for schedule(static)
+    for(size_t r=0; r<n1; r++)
+      _mpn_oz_ntt_enc_row(a, r, n1, t, precomp);
+  }
+}
+
+static void _mpn_oz_ntt_dec_four_step(mp_ptr a, const fmpz_mod_poly_oz_ntt_precomp_t precomp) {
+  const mp_size_t l = precomp->mont->nlimbs;
+  size_t w;
+  const size_t n1 = _mpn_oz_ntt_four_step_shape(&w, precomp);
+  const size_t n2 = precomp->n/n1;
+  const int nthreads = _fmpz_mod_poly_oz_ntt_nthreads(precomp);
+
+#pragma omp parallel num_threads(nthreads) if(nthreads > 1)
+  {
+    mp_limb_t t[4*l];
+#pragma omp for schedule(static)
+    for(size_t r=0; r<n1; r++)
+      _mpn_oz_ntt_dec_row(a, r, n1, t, precomp);
+#pragma omp for schedule(static)
+    for(size_t c0=0; c0<n2; c0+=w)
+      _mpn_oz_ntt_dec_cols(a, c0, (c0+w < n2) ? c0+w : n2, n1, t, precomp);
+  }
+}
+
+void _mpn_oz_ntt_enc(mp_ptr a, const fmpz_mod_poly_oz_ntt_precomp_t precomp) {
+  const size_t n = precomp->n;
+  const mp_size_t l = precomp->mont->nlimbs;
+  const size_t blk = _mpn_oz_ntt_block(l);
+  const int nthreads = _fmpz_mod_poly_oz_ntt_nthreads(precomp);
+
+  if (n >= precomp->four_step) {
+    _mpn_oz_ntt_enc_four_step(a, precomp);
+    return;
+  }
+
+#pragma omp parallel num_threads(nthreads) if(nthreads > 1)
+  {
+    mp_limb_t t[4*l];
+    mp_ptr v = t + 2*l;
+    mp_ptr u = t + 3*l;
+    mp_srcptr c = NULL;
+    size_t last = 0;
+
+    /* stage with 2m blocks of size s, block i is twisted by φ^rev(m+i) */
+    for(size_t m=1, s=n/2; m<n; m*=2, s/=2) {
+      const size_t lg_s = n_flog(s, 2);
+#pragma omp for schedule(static, blk)
+      for(size_t b=0; b<n/2; b++) {
+        const size_t i = b >> lg_s;
+        if (m+i != last) {
+          c = _mpn_oz_ntt_twiddle(u, m+i, t, precomp);
+          last = m+i;
+        }
+        mp_ptr x = a + (2*i*s + (b & (s-1)))*l;
+        mp_ptr y = x + s*l;
+        _fmpz_oz_mont_mul(v, y, c, t, precomp->mont);
+        _fmpz_oz_mont_sub(y, x, v, precomp->mont);
+        _fmpz_oz_mont_add(x, x, v, precomp->mont);
+      }
+    }
+  }
+}
+
+void _mpn_oz_ntt_dec(mp_ptr a, const fmpz_mod_poly_oz_ntt_precomp_t precomp) {
+  const size_t n = precomp->n;
+  const mp_size_t l = precomp->mont->nlimbs;
+  const size_t blk = _mpn_oz_ntt_block(l);
+  const int nthreads = _fmpz_mod_poly_oz_ntt_nthreads(precomp);
+
+  if (n == 1)
+    return;
+
+  if (n >= precomp->four_step) {
+    _mpn_oz_ntt_dec_four_step(a, precomp);
+    return;
+  }
+
+#pragma omp parallel num_threads(nthreads) if(nthreads > 1)
+  {
+    mp_limb_t t[4*l];
+    mp_ptr v = t + 2*l;
+    mp_ptr u = t + 3*l;
+    mp_srcptr c = NULL;
+    size_t last = 0;
+
+    /* (x - y)·φ^{-rev(m/2+i)} = (y - x)·φ^{rev(m-1-i)} */
+    for(size_t m=n, s=1; m>2; m/=2, s*=2) {
+      const size_t lg_s = n_flog(s, 2);
+#pragma omp for schedule(static, blk)
+      for(size_t b=0; b<n/2; b++) {
+        const size_t i = b >> lg_s;
+        if (m-1-i != last) {
+          c = _mpn_oz_ntt_twiddle(u, m-1-i, t, precomp);
+          last = m-1-i;
+        }
+        mp_ptr x = a + (2*i*s + (b & (s-1)))*l;
+        mp_ptr y = x + s*l;
+        _fmpz_oz_mont_sub(v, y, x, precomp->mont);
+        _fmpz_oz_mont_add(x, x, y, precomp->mont);
+        _fmpz_oz_mont_mul(y, v, c, t, precomp->mont);
+      }
+    }
+
+    /* last stage, 1/n is folded into both twiddles */
+    mp_srcptr c0 = precomp->n_inv_mont;
+    mp_srcptr c1 = precomp->n_inv_mont + l;
+#pragma omp for schedule(static, blk)
+    for(size_t j=0; j<n/2; j++) {
+      mp_ptr x = a + j*l;
+      mp_ptr y = x + (n/2)*l;
+      _fmpz_oz_mont_sub(v, x, y, precomp->mont);
+      _fmpz_oz_mont_add(x, x, y, precomp->mont);
+      _fmpz_oz_mont_mul(x, x, c0, t, precomp->mont);
+      _fmpz_oz_mont_mul(y, v, c1, t, precomp->mont);
+    }
+  }
+}
+
+/**
+   Write $\mbox{op}_i \bmod q$ to index $i$ of `a`.
+*/
+
+static void _mpn_oz_ntt_load(mp_ptr a, const fmpz *op, const size_t len,
+                             const fmpz_mod_poly_oz_ntt_precomp_t precomp) {
+  const fmpz *q = fmpz_mod_poly_modulus(precomp->phi);
+  const size_t n = precomp->n;
+  const mp_size_t l = precomp->mont->nlimbs;
+  const int nthreads = _fmpz_mod_poly_oz_ntt_nthreads(precomp);
+
+#pragma omp parallel num_threads(nthreads) if(nthreads > 1)
+  {
+    fmpz_t tmp;  fmpz_init(tmp);
+#pragma omp for
+    for(size_t i=0; i<n; i++) {
+      mp_ptr ai = a + i*l;
+      if (i >= len || fmpz_is_zero(op + i)) {
+        mpn_zero(ai, l);
+      } else if (fmpz_sgn(op + i) < 0 || fmpz_cmp(op + i, q) >= 0) {
+        fmpz_mod(tmp, op + i, q);
+        _fmpz_oz_get_mpn(ai, l, tmp);
+      } else {
+        _fmpz_oz_get_mpn(ai, l, op + i);
+      }
+    }
+    fmpz_clear(tmp);
+  }
+}
+
+static void _mpn_oz_ntt_store(fmpz_mod_poly_t rop, mp_srcptr a, const fmpz_mod_poly_oz_ntt_precomp_t precomp) {
+  const size_t n = precomp->n;
+  const mp_size_t l = precomp->mont->nlimbs;
+  const int nthreads = _fmpz_mod_poly_oz_ntt_nthreads(precomp);
+
+  fmpz_mod_poly_realloc(rop, n);
+#pragma omp parallel for num_threads(nthreads) if(nthreads > 1)
+  for(size_t i=0; i<n; i++)
+    _fmpz_oz_set_mpn(rop->coeffs + i, a + i*l, l);
+  rop->length = n;
+}
+
+/**
+   Return non-zero if the cache can provide tables for $n$ and $q$, i.e. if $2n | q-1$.
+*/
+
+static inline int _fmpz_mod_poly_oz_ntt_cacheable(const size_t n, const fmpz_t q) {
+  return fmpz_fdiv_ui(q, 2*n) == 1;
+}
+
 void fmpz_mod_poly_oz_ntt(fmpz_mod_poly_t rop, const fmpz_mod_poly_t op, const size_t n) {
   const fmpz *q = fmpz_mod_poly_modulus(op);
+  if (_fmpz_mod_poly_oz_ntt_cacheable(n, q)) {
+    const struct fmpz_mod_poly_oz_ntt_precomp_struct *precomp = fmpz_mod_poly_oz_ntt_precomp_get(n, q);
+    _fmpz_mod_poly_oz_ntt(rop, op, precomp->w, n);
+    fmpz_mod_poly_oz_ntt_precomp_put(precomp);
+    return;
+  }
+
   fmpz_t w;  fmpz_init(w);
   if (!_fmpz_nth_root(w, n, q)) {
     fmpz_clear(w);
@@ -131,22 +499,164 @@ void fmpz_mod_poly_oz_ntt(fmpz_mod_poly_t rop, const fmpz_mod_poly_t op, const s
 
 void fmpz_mod_poly_oz_intt(fmpz_mod_poly_t rop, const fmpz_mod_poly_t op, const size_t n) {
   const fmpz *q = fmpz_mod_poly_modulus(op);
+  if (_fmpz_mod_poly_oz_ntt_cacheable(n, q)) {
+    const struct fmpz_mod_poly_oz_ntt_precomp_struct *precomp = fmpz_mod_poly_oz_ntt_precomp_get(n, q);
+    _fmpz_mod_poly_oz_ntt_w(rop, op, precomp->w, 1, n);
+    fmpz_mod_poly_oz_ntt_precomp_put(precomp);
+    return;
+  }
+
   fmpz_t w;  fmpz_init(w);
   if (!_fmpz_nth_root(w, n, q)) {
     fmpz_clear(w);
     oz_die("q does not have a n-th root of unity");
   }
-  fmpz_invmod(w, w, fmpz_mod_poly_modulus(op));
   fmpz_mod_poly_t wvec; fmpz_mod_poly_init2(wvec, q, n);
   fmpz_mod_poly_oz_set_powers(wvec, n, w);
   fmpz_clear(w);
 
-  _fmpz_mod_poly_oz_ntt(rop, op, wvec, n);
+  _fmpz_mod_poly_oz_ntt_w(rop, op, wvec, 1, n);
   fmpz_mod_poly_clear(wvec);
 }
 
 
+/**
+   Write $c_i·R \bmod q$ to index $i$ of `rop` for $0 ≤ i < n$.
+*/
+
+static void _mpn_oz_mont_set_vec(mp_ptr rop, const fmpz *c, const size_t n, const fmpz_oz_mont_t mont) {
+  const mp_size_t l = mont->nlimbs;
+  mp_limb_t t[2*l];
+  for(size_t i=0; i<n; i++) {
+    _fmpz_oz_get_mpn(rop + i*l, l, c + i);
+    _fmpz_oz_mont_set(rop + i*l, rop + i*l, t, mont);
+  }
+}
+
+/**
+   Point `n_inv_mont` and the twiddle tables of `op` into `tables`, laid out as written by @ref
+   fmpz_mod_poly_oz_ntt_precomp_get_tables.
+*/
+
+static void _fmpz_mod_poly_oz_ntt_precomp_set_tables(fmpz_mod_poly_oz_ntt_precomp_t op, mp_srcptr tables,
+                                                     const oz_flag_t flags) {
+  const mp_size_t l = op->mont->nlimbs;
+  op->n_inv_mont = tables;
+  if (flags & OZ_NTT_SEEDED) {
+    op->seed_bits = n_flog(op->n, 2)/2;
+    op->phi_seed_mont = tables + 2*l;
+    op->phi_rev_mont = NULL;
+  } else {
+    op->seed_bits = 0;
+    op->phi_seed_mont = NULL;
+    op->phi_rev_mont = tables + 2*l;
+  }
+}
+
+/**
+   Write $φ^i \bmod q$ to index $i$ of `c` for $0 ≤ i < n$.
+*/
+
+static void _fmpz_vec_oz_set_powers(fmpz *c, const size_t n, const fmpz_t phi, const fmpz_t q) {
+  fmpz_one(c + 0);
+  for(size_t i=1; i<n; i++) {
+    fmpz_mul(c + i, c + i - 1, phi);
+    fmpz_mod(c + i, c + i, q);
+  }
+}
+
+/**
+   Set the thread count and the threshold for the four-step transforms of `op`.
+*/
+
+static void _fmpz_mod_poly_oz_ntt_precomp_set_tuning(fmpz_mod_poly_oz_ntt_precomp_t op) {
+  op->nthreads = omp_get_max_threads();
+
+  /* use the four-step transforms once an element no longer fits in cache */
+  op->four_step = 4;
+  while (op->four_step <= op->n && op->four_step * op->mont->nlimbs * sizeof(mp_limb_t) <= OZ_NTT_CACHE_BYTES)
+    op->four_step *= 2;
+}
+
+void fmpz_mod_poly_oz_ntt_precomp_init_root(fmpz_mod_poly_oz_ntt_precomp_t op, const size_t n, const fmpz_t q,
+                                            const fmpz_t phi, const oz_flag_t flags) {
+  const size_t k = n_flog(n, 2);
+  op->n = n;
+  fmpz_oz_mont_init(op->mont, q);
+
+  const mp_size_t l = op->mont->nlimbs;
+  op->tables = (mp_ptr)malloc(fmpz_mod_poly_oz_ntt_precomp_tables_size(n, l, flags) * sizeof(mp_limb_t));
+  if (op->tables == NULL)
+    oz_die("failed to allocate NTT tables");
+  op->borrowed = 0;
+  _fmpz_mod_poly_oz_ntt_precomp_set_tables(op, op->tables, flags);
+
+  if (flags & OZ_NTT_COMPACT) {
+    fmpz_mod_poly_init(op->w, q);
+    fmpz_mod_poly_init2(op->phi, q, 2);
+    fmpz_mod_poly_oz_set_powers(op->phi, (n > 1) ? 2 : 1, phi);
+  } else {
+    fmpz_t w;  fmpz_init(w);
+    fmpz_mul(w, phi, phi);
+    fmpz_mod(w, w, q);
+    fmpz_mod_poly_init2(op->w, q, n);
+    fmpz_mod_poly_oz_set_powers(op->w, n, w);
+    fmpz_clear(w);
+
+    fmpz_mod_poly_init2(op->phi, q, n);
+    fmpz_mod_poly_oz_set_powers(op->phi, n, phi);
+  }
+
+  /* twiddles in the order used by the merged transforms, or φ^{e_0} and φ^{2^b·e_1} */
+  if (flags & OZ_NTT_SEEDED) {
+    const size_t b = k/2;
+    const size_t n0 = ((size_t)1) << b;
+    const size_t n1 = n >> b;
+    fmpz *c = _fmpz_vec_init(n0 + n1);
+    fmpz_t phi_b;  fmpz_init(phi_b);
+    fmpz_powm_ui(phi_b, phi, n0, q);
+    _fmpz_vec_oz_set_powers(c, n0, phi, q);
+    _fmpz_vec_oz_set_powers(c + n0, n1, phi_b, q);
+    fmpz_clear(phi_b);
+
+    _mpn_oz_mont_set_vec(op->tables + 2*l, c, n0 + n1, op->mont);
+    _fmpz_vec_clear(c, n0 + n1);
+  } else {
+    fmpz *c = _fmpz_vec_init(n);
+    _fmpz_vec_oz_set_powers(c, n, phi, q);
+    for(size_t i=0; i<n; i++) {
+      const size_t j = n_revbin(i, k);
+      if (i < j)
+        fmpz_swap(c + i, c + j);
+    }
+
+    _mpn_oz_mont_set_vec(op->tables + 2*l, c, n, op->mont);
+    _fmpz_vec_clear(c, n);
+  }
+
+  /** @note We fold 1/n into both twiddles of the last stage, φ^{-n/2} = -φ^{n/2} **/
+  fmpz *c = _fmpz_vec_init(2);
+  fmpz_set_ui(c + 0, n);
+  fmpz_invmod(c + 0, c + 0, q);
+  if (n > 1) {
+    fmpz_powm_ui(c + 1, phi, n/2, q);
+    fmpz_sub(c + 1, q, c + 1);
+    fmpz_mul(c + 1, c + 1, c + 0);
+    fmpz_mod(c + 1, c + 1, q);
+  } else {
+    fmpz_set(c + 1, c + 0);
+  }
+  _mpn_oz_mont_set_vec(op->tables, c, 2, op->mont);
+  _fmpz_vec_clear(c, 2);
+  _fmpz_mod_poly_oz_ntt_precomp_set_tuning(op);
+}
+
 void fmpz_mod_poly_oz_ntt_precomp_init(fmpz_mod_poly_oz_ntt_precomp_t op, const size_t n, const fmpz_t q) {
+  fmpz_mod_poly_oz_ntt_precomp_init_flags(op, n, q, 0);
+}
+
+void fmpz_mod_poly_oz_ntt_precomp_init_flags(fmpz_mod_poly_oz_ntt_precomp_t op, const size_t n, const fmpz_t q,
+                                             const oz_flag_t flags) {
   fmpz_t w;  fmpz_init(w);
   if (!_fmpz_nth_root(w, n, q)) {
     fmpz_clear(w);
@@ -158,48 +668,161 @@ void fmpz_mod_poly_oz_ntt_precomp_init(fmpz_mod_poly_oz_ntt_precomp_t op, const
     fmpz_clear(phi);
     oz_die("q does not have a 2n-th root of unity");
   }
-
-  op->n = n;
-
-  fmpz_mod_poly_init2(op->w, q, n);
-  fmpz_mod_poly_oz_set_powers(op->w, n, w);
-
-  fmpz_invmod(w, w, q);
-  fmpz_mod_poly_init2(op->w_inv, q, n);
-  fmpz_mod_poly_oz_set_powers(op->w_inv, n, w);
   fmpz_clear(w);
 
-  fmpz_mod_poly_init2(op->phi, q, n);
-  fmpz_mod_poly_oz_set_powers(op->phi, n, phi);
-
-  fmpz_invmod(phi, phi, q);
-  fmpz_mod_poly_init2(op->phi_inv, q, n);
-  fmpz_mod_poly_oz_set_powers(op->phi_inv, n, phi);
+  fmpz_mod_poly_oz_ntt_precomp_init_root(op, n, q, phi, flags);
   fmpz_clear(phi);
+}
 
-  /** @note We fold 1/n into φ^-1 **/
-  fmpz_t n_inv;  fmpz_init_set_ui(n_inv, n);
-  fmpz_invmod(n_inv, n_inv, q);
+void fmpz_mod_poly_oz_ntt_precomp_init_crt(fmpz_mod_poly_oz_ntt_precomp_t op, const size_t n,
+                                           const mp_limb_t *primes, const size_t k) {
+  fmpz_mod_poly_oz_ntt_precomp_init_crt_flags(op, n, primes, k, 0);
+}
 
-  for(size_t i=0; i<n; i++) {
-    fmpz_mul(op->phi_inv->coeffs+i, n_inv, op->phi_inv->coeffs+i);
-    fmpz_mod(op->phi_inv->coeffs+i, op->phi_inv->coeffs+i, q);
+void fmpz_mod_poly_oz_ntt_precomp_init_crt_flags(fmpz_mod_poly_oz_ntt_precomp_t op, const size_t n,
+                                                 const mp_limb_t *primes, const size_t k, const oz_flag_t flags) {
+  fmpz_t q;  fmpz_init_set_ui(q, 1);
+  fmpz_t phi;  fmpz_init_set_ui(phi, 0);
+  fmpz_t t;  fmpz_init(t);
+
+  /* φ = CRT(φ_0, …, φ_{k-1}) where φ_i is a primitive 2n-th root of unity mod p_i */
+  for(size_t i=0; i<k; i++) {
+    if ((primes[i] - 1) % (2*n))
+      oz_die("p_%zu does not have a 2n-th root of unity", i);
+    const mp_limb_t phi_i = _nmod_nth_root(2*n, primes[i]);
+    fmpz_CRT_ui(t, phi, q, phi_i, primes[i], 0);
+    fmpz_swap(phi, t);
+    fmpz_mul_ui(q, q, primes[i]);
   }
-  fmpz_clear(n_inv);
+  fmpz_clear(t);
+
+  fmpz_mod_poly_oz_ntt_precomp_init_root(op, n, q, phi, flags);
+  fmpz_clear(phi);
+  fmpz_clear(q);
 }
 
 void fmpz_mod_poly_oz_ntt_precomp_clear(fmpz_mod_poly_oz_ntt_precomp_t op) {
   fmpz_mod_poly_clear(op->w);
-  fmpz_mod_poly_clear(op->w_inv);
   fmpz_mod_poly_clear(op->phi);
-  fmpz_mod_poly_clear(op->phi_inv);
+  if (!op->borrowed)
+    free(op->tables);
+  fmpz_oz_mont_clear(op->mont);
+}
+
+size_t fmpz_mod_poly_oz_ntt_precomp_tables_size(const size_t n, const mp_size_t nlimbs, const oz_flag_t flags) {
+  if (flags & OZ_NTT_SEEDED) {
+    const size_t b = n_flog(n, 2)/2;
+    return (2 + (((size_t)1) << b) + (n >> b)) * nlimbs;
+  }
+  return (2 + n) * nlimbs;
+}
+
+void fmpz_mod_poly_oz_ntt_precomp_get_tables(mp_ptr rop, const fmpz_mod_poly_oz_ntt_precomp_t op) {
+  const mp_size_t l = op->mont->nlimbs;
+  mpn_copyi(rop, op->n_inv_mont, 2*l);
+  if (op->phi_seed_mont) {
+    const size_t n0 = ((size_t)1) << op->seed_bits;
+    const size_t n1 = op->n >> op->seed_bits;
+    mpn_copyi(rop + 2*l, op->phi_seed_mont, (n0 + n1)*l);
+  } else {
+    mpn_copyi(rop + 2*l, op->phi_rev_mont, op->n*l);
+  }
+}
+
+void fmpz_mod_poly_oz_ntt_precomp_init_tables(fmpz_mod_poly_oz_ntt_precomp_t op, const size_t n, const fmpz_t q,
+                                              const fmpz_t phi, mp_srcptr tables, const oz_flag_t flags) {
+  op->n = n;
+  fmpz_oz_mont_init(op->mont, q);
+  fmpz_mod_poly_init(op->w, q);
+  fmpz_mod_poly_init2(op->phi, q, 2);
+  fmpz_mod_poly_oz_set_powers(op->phi, (n > 1) ? 2 : 1, phi);
+
+  op->tables = NULL;
+  op->borrowed = 1;
+  _fmpz_mod_poly_oz_ntt_precomp_set_tables(op, tables, flags);
+  _fmpz_mod_poly_oz_ntt_precomp_set_tuning(op);
+}
+
+/**
+   Entry of the process-wide pre-computation cache, a singly linked list protected by the critical
+   section `oz_ntt_precomp_cache`.
+*/
+
+struct _fmpz_mod_poly_oz_ntt_cache_entry {
+  size_t n;
+  fmpz_t q;
+  int refs;
+  fmpz_mod_poly_oz_ntt_precomp_t precomp;
+  struct _fmpz_mod_poly_oz_ntt_cache_entry *next;
+};
+
+static struct _fmpz_mod_poly_oz_ntt_cache_entry *_fmpz_mod_poly_oz_ntt_cache = NULL;
+
+const struct fmpz_mod_poly_oz_ntt_precomp_struct *fmpz_mod_poly_oz_ntt_precomp_get(const size_t n, const fmpz_t q) {
+  struct _fmpz_mod_poly_oz_ntt_cache_entry *e;
+
+  /* we build under the lock so that concurrent callers never duplicate the work */
+#pragma omp critical(oz_ntt_precomp_cache)
+  {
+    for(e = _fmpz_mod_poly_oz_ntt_cache; e; e = e->next)
+      if (e->n == n && fmpz_equal(e->q, q))
+        break;
+    if (e == NULL) {
+      e = (struct _fmpz_mod_poly_oz_ntt_cache_entry*)malloc(sizeof(struct _fmpz_mod_poly_oz_ntt_cache_entry));
+      if (e == NULL)
+        oz_die("failed to allocate cache entry");
+      e->n = n;
+      fmpz_init_set(e->q, q);
+      e->refs = 0;
+      fmpz_mod_poly_oz_ntt_precomp_init(e->precomp, n, q);
+      e->next = _fmpz_mod_poly_oz_ntt_cache;
+      _fmpz_mod_poly_oz_ntt_cache = e;
+    }
+    e->refs++;
+  }
+  return e->precomp;
+}
+
+void fmpz_mod_poly_oz_ntt_precomp_put(const struct fmpz_mod_poly_oz_ntt_precomp_struct *op) {
+#pragma omp critical(oz_ntt_precomp_cache)
+  {
+    struct _fmpz_mod_poly_oz_ntt_cache_entry *e;
+    for(e = _fmpz_mod_poly_oz_ntt_cache; e; e = e->next)
+      if (e->precomp == op)
+        break;
+    if (e == NULL)
+      oz_die("pre-computation was not obtained from the cache");
+    assert(e->refs > 0);
+    e->refs--;
+  }
+}
+
+size_t fmpz_mod_poly_oz_ntt_precomp_cache_clear(void) {
+  size_t in_use = 0;
+#pragma omp critical(oz_ntt_precomp_cache)
+  {
+    struct _fmpz_mod_poly_oz_ntt_cache_entry **p = &_fmpz_mod_poly_oz_ntt_cache;
+    while (*p) {
+      struct _fmpz_mod_poly_oz_ntt_cache_entry *e = *p;
+      if (e->refs) {
+        in_use++;
+        p = &e->next;
+        continue;
+      }
+      *p = e->next;
+      fmpz_mod_poly_oz_ntt_precomp_clear(e->precomp);
+      fmpz_clear(e->q);
+      free(e);
+    }
+  }
+  return in_use;
 }
 
 void fmpz_mod_poly_oz_ntt_mul(fmpz_mod_poly_t h, const fmpz_mod_poly_t f, const fmpz_mod_poly_t g, const size_t n) {
   const fmpz *q = fmpz_mod_poly_modulus(f);
   fmpz_mod_poly_realloc(h, n);
 
-/* #pragma omp parallel for */
+#pragma omp parallel for
   for(size_t i=0; i<n; i++) {
     fmpz_mul(h->coeffs + i, f->coeffs + i, g->coeffs + i);
     fmpz_mod(h->coeffs + i, h->coeffs+i, q);
@@ -207,6 +830,216 @@ void fmpz_mod_poly_oz_ntt_mul(fmpz_mod_poly_t h, const fmpz_mod_poly_t f, const
   h->length = n;
 }
 
+/**
+   Write $f_i$ to `x` if $0 ≤ f_i < 2^{wℓ}$ and $f_i \bmod q$ otherwise. Return 0 if $f_i = 0$.
+*/
+
+static inline int _mpn_oz_ntt_get_coeff(mp_ptr x, const fmpz_mod_poly_t f, const size_t i, const mp_size_t l,
+                                        fmpz_t tmp, const fmpz_t q) {
+  if (i >= (size_t)f->length || fmpz_is_zero(f->coeffs + i))
+    return 0;
+  const fmpz *c = f->coeffs + i;
+  if (fmpz_sgn(c) < 0 || fmpz_size(c) > l) {
+    fmpz_mod(tmp, c, q);
+    c = tmp;
+  }
+  _fmpz_oz_get_mpn(x, l, c);
+  return 1;
+}
+
+void _fmpz_mod_poly_oz_ntt_mul(fmpz_mod_poly_t h, const fmpz_mod_poly_t f, const fmpz_mod_poly_t g,
+                               const fmpz_mod_poly_oz_ntt_precomp_t precomp) {
+  const fmpz *q = fmpz_mod_poly_modulus(precomp->phi);
+  const size_t n = precomp->n;
+  const mp_size_t l = precomp->mont->nlimbs;
+  const int nthreads = _fmpz_mod_poly_oz_ntt_nthreads(precomp);
+
+  fmpz_mod_poly_realloc(h, n);
+#pragma omp parallel num_threads(nthreads) if(nthreads > 1)
+  {
+    mp_limb_t x[4*l];
+    mp_ptr y = x + l;
+    mp_ptr t = y + l;
+    fmpz_t tmp;  fmpz_init(tmp);
+#pragma omp for
+    for(size_t i=0; i<n; i++) {
+      if (!_mpn_oz_ntt_get_coeff(x, f, i, l, tmp, q) || !_mpn_oz_ntt_get_coeff(y, g, i, l, tmp, q)) {
+        fmpz_zero(h->coeffs + i);
+        continue;
+      }
+      _fmpz_oz_mont_mulmod(x, x, y, t, precomp->mont);
+      _fmpz_oz_set_mpn(h->coeffs + i, x, l);
+    }
+    fmpz_clear(tmp);
+  }
+  h->length = n;
+}
+
+void _fmpz_mod_poly_oz_ntt_mul_many(fmpz_mod_poly_t h, fmpz_mod_poly_t *f, const size_t len,
+                                    const fmpz_mod_poly_oz_ntt_precomp_t precomp) {
+  const fmpz *q = fmpz_mod_poly_modulus(precomp->phi);
+  const size_t n = precomp->n;
+  const mp_size_t l = precomp->mont->nlimbs;
+  const int nthreads = _fmpz_mod_poly_oz_ntt_nthreads(precomp);
+
+  if (len == 0) {
+    fmpz_mod_poly_oz_ntt_set_ui(h, 1, n);
+    return;
+  }
+
+  /* every factor costs one REDC, i.e. a factor R^{-1}, which we compensate for up front with
+     c = R^len mod q */
+  mp_limb_t c[l];
+  {
+    fmpz_t r;  fmpz_init(r);
+    fmpz_set_ui(r, 1);
+    fmpz_mul_2exp(r, r, l*FLINT_BITS);
+    fmpz_powm_ui(r, r, len, q);
+    _fmpz_oz_get_mpn(c, l, r);
+    fmpz_clear(r);
+  }
+
+  fmpz_mod_poly_realloc(h, n);
+#pragma omp parallel num_threads(nthreads) if(nthreads > 1)
+  {
+    mp_limb_t x[4*l];
+    mp_ptr y = x + l;
+    mp_ptr t = y + l;
+    fmpz_t tmp;  fmpz_init(tmp);
+#pragma omp for
+    for(size_t i=0; i<n; i++) {
+      int nonzero = _mpn_oz_ntt_get_coeff(x, f[0], i, l, tmp, q);
+      if (nonzero)
+        _fmpz_oz_mont_mul(x, x, c, t, precomp->mont);
+      for(size_t j=1; nonzero && j<len; j++) {
+        nonzero = _mpn_oz_ntt_get_coeff(y, f[j], i, l, tmp, q);
+        if (!nonzero)
+          break;
+        _fmpz_oz_mont_mul(x, x, y, t, precomp->mont);
+      }
+      if (!nonzero) {
+        fmpz_zero(h->coeffs + i);
+        continue;
+      }
+      _fmpz_oz_set_mpn(h->coeffs + i, x, l);
+    }
+    fmpz_clear(tmp);
+  }
+  h->length = n;
+  _fmpz_mod_poly_normalise(h);
+}
+
+/**
+   Compute $h_i = (c·h_i + \sum_j f_{j,i}·g_{j,i}) \bmod q$ for $c ∈ \{0,1\}$. Products are
+   accumulated unreduced in $2ℓ+1$ limbs and reduced by a single division at the end.
+*/
+
+static void _fmpz_mod_poly_oz_ntt_dot_acc(fmpz_mod_poly_t h, const int acc_h, const fmpz_mod_poly_struct *f,
+                                          const fmpz_mod_poly_struct *g, const size_t len, const fmpz_mod_poly_oz_ntt_precomp_t precomp) {
+  const fmpz *q = fmpz_mod_poly_modulus(precomp->phi);
+  const size_t n = precomp->n;
+  const mp_size_t l = precomp->mont->nlimbs;
+  const int nthreads = _fmpz_mod_poly_oz_ntt_nthreads(precomp);
+  const slong h_len = h->length;
+
+  fmpz_mod_poly_realloc(h, n);
+#pragma omp parallel num_threads(nthreads) if(nthreads > 1)
+  {
+    mp_limb_t acc[2*l+1];
+    mp_limb_t p[2*l];
+    mp_limb_t x[l];
+    mp_limb_t y[l];
+    mp_limb_t quo[l+2];
+    fmpz_t tmp;  fmpz_init(tmp);
+#pragma omp for
+    for(size_t i=0; i<n; i++) {
+      mpn_zero(acc, 2*l+1);
+      if (acc_h && i < (size_t)h_len && !fmpz_is_zero(h->coeffs + i)) {
+        const fmpz *c = h->coeffs + i;
+        if (fmpz_sgn(c) < 0 || fmpz_size(c) > l) {
+          fmpz_mod(tmp, c, q);
+          c = tmp;
+        }
+        _fmpz_oz_get_mpn(acc, l, c);
+      }
+      for(size_t j=0; j<len; j++) {
+        if (!_mpn_oz_ntt_get_coeff(x, f + j, i, l, tmp, q) || !_mpn_oz_ntt_get_coeff(y, g + j, i, l, tmp, q))
+          continue;
+        mpn_mul_n(p, x, y, l);
+        acc[2*l] += mpn_add_n(acc, acc, p, 2*l);
+      }
+      mp_size_t s = 2*l+1;
+      while (s > 0 && acc[s-1] == 0)
+        s--;
+      if (s >= l) {
+        mpn_tdiv_qr(quo, x, 0, acc, s, precomp->mont->q, l);
+        _fmpz_oz_set_mpn(h->coeffs + i, x, l);
+      } else {
+        _fmpz_oz_set_mpn(h->coeffs + i, acc, s);
+      }
+    }
+    fmpz_clear(tmp);
+  }
+  h->length = n;
+}
+
+void _fmpz_mod_poly_oz_ntt_addmul(fmpz_mod_poly_t h, const fmpz_mod_poly_t f, const fmpz_mod_poly_t g,
+                                  const fmpz_mod_poly_oz_ntt_precomp_t precomp) {
+  _fmpz_mod_poly_oz_ntt_dot_acc(h, 1, f, g, 1, precomp);
+}
+
+void _fmpz_mod_poly_oz_ntt_dot(fmpz_mod_poly_t h, fmpz_mod_poly_t *f, fmpz_mod_poly_t *g, const size_t len,
+                               const fmpz_mod_poly_oz_ntt_precomp_t precomp) {
+  _fmpz_mod_poly_oz_ntt_dot_acc(h, 0, len ? *f : NULL, len ? *g : NULL, len, precomp);
+}
+
+void _fmpz_mod_poly_oz_ntt_add_lazy(fmpz_mod_poly_t h, const fmpz_mod_poly_t f, const fmpz_mod_poly_t g,
+                                    const fmpz_mod_poly_oz_ntt_precomp_t precomp) {
+  const size_t n = precomp->n;
+  const size_t f_len = f->length;
+  const size_t g_len = g->length;
+
+  fmpz_mod_poly_realloc(h, n);
+  for(size_t i=0; i<n; i++) {
+    if (i < f_len && i < g_len)
+      fmpz_add(h->coeffs + i, f->coeffs + i, g->coeffs + i);
+    else if (i < f_len)
+      fmpz_set(h->coeffs + i, f->coeffs + i);
+    else if (i < g_len)
+      fmpz_set(h->coeffs + i, g->coeffs + i);
+    else
+      fmpz_zero(h->coeffs + i);
+  }
+  /* not normalised, as in _fmpz_mod_poly_oz_ntt_sub_lazy, the consuming kernel returns a reduced
+     and normalised element */
+  h->length = n;
+}
+
+void _fmpz_mod_poly_oz_ntt_sub_lazy(fmpz_mod_poly_t h, const fmpz_mod_poly_t f, const fmpz_mod_poly_t g,
+                                    const fmpz_mod_poly_oz_ntt_precomp_t precomp) {
+  const fmpz *q = fmpz_mod_poly_modulus(precomp->phi);
+  const size_t n = precomp->n;
+  const size_t f_len = f->length;
+  const size_t g_len = g->length;
+
+  fmpz_mod_poly_realloc(h, n);
+  for(size_t i=0; i<n; i++) {
+    if (i < f_len && i < g_len)
+      fmpz_sub(h->coeffs + i, f->coeffs + i, g->coeffs + i);
+    else if (i < f_len)
+      fmpz_set(h->coeffs + i, f->coeffs + i);
+    else if (i < g_len)
+      fmpz_neg(h->coeffs + i, g->coeffs + i);
+    else
+      fmpz_zero(h->coeffs + i);
+    /* at most k iterations for g_i < kq */
+    while (fmpz_sgn(h->coeffs + i) < 0)
+      fmpz_add(h->coeffs + i, h->coeffs + i, q);
+  }
+  /* not normalised, cf. _fmpz_mod_poly_oz_ntt_add_lazy */
+  h->length = n;
+}
+
 void fmpz_mod_poly_oz_ntt_inv(fmpz_mod_poly_t h, const fmpz_mod_poly_t f, const size_t n) {
   const fmpz *q = fmpz_mod_poly_modulus(f);
   fmpz_mod_poly_realloc(h, n);
@@ -218,6 +1051,127 @@ void fmpz_mod_poly_oz_ntt_inv(fmpz_mod_poly_t h, const fmpz_mod_poly_t f, const
   h->length = n;
 }
 
+/**
+   Montgomery's trick on $N = \mbox{len}·n$ slots. The slots are split into one chunk per thread,
+   each chunk stores its running products in `h` and the chunk totals are inverted together with a
+   single call to `fmpz_invmod`. All multiplications are Montgomery multiplications on plain
+   residues: the prefix of the $k$-th non-zero slot of a chunk carries a factor $R^{-k}$, its inverse
+   $R^k$, and these cancel when the two are multiplied to produce the output.
+*/
+
+void _fmpz_mod_poly_oz_ntt_inv_many(fmpz_mod_poly_t *h, fmpz_mod_poly_t *f, const size_t len,
+                                    const fmpz_mod_poly_oz_ntt_precomp_t precomp) {
+  const fmpz *q = fmpz_mod_poly_modulus(precomp->phi);
+  const size_t n = precomp->n;
+  const mp_size_t l = precomp->mont->nlimbs;
+  const size_t N = len*n;
+
+  if (N == 0)
+    return;
+
+  const size_t nthreads = omp_in_parallel() ? 1 : (size_t)precomp->nthreads;
+  const size_t nchunks = (nthreads < N) ? nthreads : N;
+  fmpz *tot = _fmpz_vec_init(nchunks);
+
+  for(size_t j=0; j<len; j++)
+    fmpz_mod_poly_realloc(h[j], n);
+
+#pragma omp parallel num_threads(nchunks) if(nchunks > 1)
+  {
+    mp_limb_t x[5*l];
+    mp_ptr y = x + l;
+    mp_ptr z = y + l;
+    mp_ptr t = z + l;
+    fmpz_t tmp;  fmpz_init(tmp);
+
+    /* forward: h_k = f_s ⋯ f_k R^{-(k-s)} skipping zeros, leading zeros of a chunk give h_k = 0 */
+#pragma omp for schedule(static,1)
+    for(size_t c=0; c<nchunks; c++) {
+      const size_t s = c*N/nchunks, e = (c+1)*N/nchunks;
+      int empty = 1;
+      for(size_t k=s; k<e; k++) {
+        fmpz *hk = h[k/n]->coeffs + k%n;
+        if (!_mpn_oz_ntt_get_coeff(y, f[k/n], k%n, l, tmp, q)) {
+          if (empty)
+            fmpz_zero(hk);
+          else
+            fmpz_set(hk, h[(k-1)/n]->coeffs + (k-1)%n);
+          continue;
+        }
+        if (empty)
+          mpn_copyi(x, y, l);
+        else
+          _fmpz_oz_mont_mul(x, x, y, t, precomp->mont);
+        empty = 0;
+        _fmpz_oz_set_mpn(hk, x, l);
+      }
+      if (empty)
+        fmpz_zero(tot + c);
+      else
+        fmpz_set(tot + c, h[(e-1)/n]->coeffs + (e-1)%n);
+    }
+
+#pragma omp single
+    {
+      /* invert the non-zero chunk totals with one inversion, tmp holds the running product */
+      fmpz *pre = _fmpz_vec_init(nchunks);
+      fmpz_set_ui(tmp, 1);
+      for(size_t c=0; c<nchunks; c++) {
+        fmpz_set(pre + c, tmp);
+        if (!fmpz_is_zero(tot + c)) {
+          fmpz_mul(tmp, tmp, tot + c);
+          fmpz_mod(tmp, tmp, q);
+        }
+      }
+      if (!fmpz_invmod(tmp, tmp, q))
+        oz_die("element not invertible modulo q");
+      for(size_t c=nchunks; c-- > 0; ) {
+        if (fmpz_is_zero(tot + c))
+          continue;
+        fmpz_mul(pre + c, pre + c, tmp);
+        fmpz_mul(tmp, tmp, tot + c);
+        fmpz_mod(tmp, tmp, q);
+        fmpz_mod(tot + c, pre + c, q);
+      }
+      _fmpz_vec_clear(pre, nchunks);
+    }
+
+    /* backward: x = (f_s ⋯ f_k)^{-1} R^{k-s} */
+#pragma omp for schedule(static,1)
+    for(size_t c=0; c<nchunks; c++) {
+      const size_t s = c*N/nchunks, e = (c+1)*N/nchunks;
+      if (fmpz_is_zero(tot + c)) {
+        for(size_t k=s; k<e; k++)
+          fmpz_zero(h[k/n]->coeffs + k%n);
+        continue;
+      }
+      _fmpz_oz_get_mpn(x, l, tot + c);
+      for(size_t k=e; k-- > s; ) {
+        fmpz *hk = h[k/n]->coeffs + k%n;
+        if (!_mpn_oz_ntt_get_coeff(z, f[k/n], k%n, l, tmp, q)) {
+          fmpz_zero(hk);
+          continue;
+        }
+        const fmpz *prev = (k > s) ? h[(k-1)/n]->coeffs + (k-1)%n : NULL;
+        if (prev == NULL || fmpz_is_zero(prev)) {
+          /* first non-zero slot of the chunk, no scaling to cancel */
+          _fmpz_oz_set_mpn(hk, x, l);
+          continue;
+        }
+        _fmpz_oz_get_mpn(y, l, prev);
+        _fmpz_oz_mont_mul(y, x, y, t, precomp->mont);
+        _fmpz_oz_set_mpn(hk, y, l);
+        _fmpz_oz_mont_mul(x, x, z, t, precomp->mont);
+      }
+    }
+    fmpz_clear(tmp);
+  }
+
+  for(size_t j=0; j<len; j++)
+    h[j]->length = n;
+  _fmpz_vec_clear(tot, nchunks);
+}
+
 void fmpz_mod_poly_oz_ntt_set_ui(fmpz_mod_poly_t op, const unsigned long c, const size_t n) {
   fmpz_mod_poly_realloc(op, n);
   for(size_t i=0; i<n; i++)
@@ -240,45 +1194,153 @@ void fmpz_mod_poly_oz_ntt_pow_ui(fmpz_mod_poly_t rop, const fmpz_mod_poly_t f, u
   fmpz_mod_poly_clear(tmp);
 }
 
-void fmpz_mod_poly_oz_ntt_enc_fmpz_poly(fmpz_mod_poly_t rop, const fmpz_poly_t op, const fmpz_mod_poly_oz_ntt_precomp_t precomp) {
+void _fmpz_mod_poly_oz_ntt_pow_ui(fmpz_mod_poly_t rop, const fmpz_mod_poly_t f, unsigned long e,
+                                  const fmpz_mod_poly_oz_ntt_precomp_t precomp) {
+  const size_t n = precomp->n;
+  if (e == 0) {
+    fmpz_mod_poly_oz_ntt_set_ui(rop, 1, n);
+    return;
+  }
   const fmpz *q = fmpz_mod_poly_modulus(precomp->phi);
-  fmpz_mod_poly_realloc(rop, precomp->n);
+  const mp_size_t l = precomp->mont->nlimbs;
+  const int nthreads = _fmpz_mod_poly_oz_ntt_nthreads(precomp);
 
-  fmpz_poly_t t; fmpz_poly_init2(t, precomp->n);
-  fmpz_poly_set(t, op);
-
-/* #pragma omp parallel for */
-  for(size_t i=0; i<precomp->n; i++) {
-    fmpz_mul(rop->coeffs+i, precomp->phi->coeffs+i, t->coeffs+i);
-    fmpz_mod(rop->coeffs+i, rop->coeffs+i, q);
+  fmpz_mod_poly_realloc(rop, n);
+#pragma omp parallel num_threads(nthreads) if(nthreads > 1)
+  {
+    mp_limb_t x[4*l];
+    mp_ptr y = x + l;
+    mp_ptr t = y + l;
+    fmpz_t tmp;  fmpz_init(tmp);
+#pragma omp for
+    for(size_t i=0; i<n; i++) {
+      if (!_mpn_oz_ntt_get_coeff(x, f, i, l, tmp, q)) {
+        fmpz_zero(rop->coeffs + i);
+        continue;
+      }
+      /* square-and-multiply in Montgomery representation */
+      _fmpz_oz_mont_set(x, x, t, precomp->mont);
+      mpn_copyi(y, x, l);
+      for(long b = FLINT_BIT_COUNT(e) - 2; b >= 0; b--) {
+        _fmpz_oz_mont_mul(y, y, y, t, precomp->mont);
+        if ((e>>b) & 1)
+          _fmpz_oz_mont_mul(y, y, x, t, precomp->mont);
+      }
+      _fmpz_oz_mont_get(y, y, t, precomp->mont);
+      _fmpz_oz_set_mpn(rop->coeffs + i, y, l);
+    }
+    fmpz_clear(tmp);
   }
-  rop->length = precomp->n;
-  _fmpz_mod_poly_oz_ntt(rop, rop, precomp->w, precomp->n);
-  fmpz_poly_clear(t);
+  rop->length = n;
+}
+
+void fmpz_mod_poly_oz_ntt_enc_fmpz_poly(fmpz_mod_poly_t rop, const fmpz_poly_t op, const fmpz_mod_poly_oz_ntt_precomp_t precomp) {
+  const size_t n = precomp->n;
+  const mp_size_t l = precomp->mont->nlimbs;
+  mp_ptr a = (mp_ptr)malloc(n * l * sizeof(mp_limb_t));
+
+  _mpn_oz_ntt_load(a, op->coeffs, op->length, precomp);
+  _mpn_oz_ntt_enc(a, precomp);
+  _mpn_oz_ntt_store(rop, a, precomp);
+
+  free(a);
 }
 
 void fmpz_mod_poly_oz_ntt_enc(fmpz_mod_poly_t rop, const fmpz_mod_poly_t op, const fmpz_mod_poly_oz_ntt_precomp_t precomp) {
-  const fmpz *q = fmpz_mod_poly_modulus(op);
-  fmpz_mod_poly_realloc(rop, precomp->n);
+  const size_t n = precomp->n;
+  const mp_size_t l = precomp->mont->nlimbs;
+  mp_ptr a = (mp_ptr)malloc(n * l * sizeof(mp_limb_t));
 
-/* #pragma omp parallel for */
-  for(size_t i=0; i<precomp->n; i++) {
-    fmpz_mul(rop->coeffs+i, precomp->phi->coeffs+i, op->coeffs+i);
-    fmpz_mod(rop->coeffs+i, rop->coeffs+i, q);
-  }
-  rop->length = precomp->n;
-  _fmpz_mod_poly_oz_ntt(rop, rop, precomp->w, precomp->n);
+  _mpn_oz_ntt_load(a, op->coeffs, op->length, precomp);
+  _mpn_oz_ntt_enc(a, precomp);
+  _mpn_oz_ntt_store(rop, a, precomp);
+
+  free(a);
 }
 
 void fmpz_mod_poly_oz_ntt_dec(fmpz_mod_poly_t rop, const fmpz_mod_poly_t op, const fmpz_mod_poly_oz_ntt_precomp_t precomp) {
-  const fmpz *q = fmpz_mod_poly_modulus(op);
+  const size_t n = precomp->n;
+  const mp_size_t l = precomp->mont->nlimbs;
+  mp_ptr a = (mp_ptr)malloc(n * l * sizeof(mp_limb_t));
+
+  _mpn_oz_ntt_load(a, op->coeffs, op->length, precomp);
+  _mpn_oz_ntt_dec(a, precomp);
+  _mpn_oz_ntt_store(rop, a, precomp);
+
+  free(a);
+}
 
-  _fmpz_mod_poly_oz_ntt(rop, op, precomp->w_inv, precomp->n);
 
-/* #pragma omp parallel for */
-  for(size_t i=0; i<precomp->n; i++) {
-    fmpz_mul(rop->coeffs+i, precomp->phi_inv->coeffs+i, rop->coeffs+i);
-    fmpz_mod(rop->coeffs+i, rop->coeffs+i, q);
+void _fmpz_mod_poly_oz_ntt_dec_row(mp_ptr row, const size_t j, const fmpz_mod_poly_t f,
+                                   const fmpz_mod_poly_oz_ntt_precomp_t precomp) {
+  const fmpz *q = fmpz_mod_poly_modulus(precomp->phi);
+  const size_t n = precomp->n;
+  const size_t k = n_flog(n, 2);
+  const mp_size_t l = precomp->mont->nlimbs;
+  const int nthreads = _fmpz_mod_poly_oz_ntt_nthreads(precomp);
+
+  fmpz_t n_inv;  fmpz_init_set_ui(n_inv, n);
+  fmpz_invmod(n_inv, n_inv, q);
+
+  /* slot i holds a(φ^{2·rev(i)+1}) hence a_j = n^{-1} Σ_i A_i φ^{-(2·rev(i)+1)·j} where φ^{e+n} = -φ^e */
+#pragma omp parallel num_threads(nthreads) if(nthreads > 1)
+  {
+    fmpz_t c;  fmpz_init(c);
+    mp_limb_t t[3*l];
+    mp_ptr u = t + 2*l;
+#pragma omp for
+    for(size_t i=0; i<n; i++) {
+      const size_t e = (2*n - ((2*n_revbin(i, k) + 1) * j) % (2*n)) % (2*n);
+      /* φ^{e mod n} is twiddle rev(e mod n), the table `phi` might not be stored */
+      mp_srcptr phi_e = _mpn_oz_ntt_twiddle(u, n_revbin(e % n, k), t, precomp);
+      _fmpz_oz_mont_get(row + i*l, phi_e, t, precomp->mont);
+      _fmpz_oz_set_mpn(c, row + i*l, l);
+      fmpz_mul(c, c, n_inv);
+      if (e >= n)
+        fmpz_neg(c, c);
+      if (f != NULL) {
+        if (i < (size_t)f->length)
+          fmpz_mul(c, c, f->coeffs + i);
+        else
+          fmpz_zero(c);
+      }
+      fmpz_mod(c, c, q);
+      _fmpz_oz_get_mpn(row + i*l, l, c);
+    }
+    fmpz_clear(c);
+  }
+  fmpz_clear(n_inv);
+}
+
+void _fmpz_mod_poly_oz_ntt_dec_coeff(fmpz_t rop, const fmpz_mod_poly_t op, mp_srcptr row,
+                                     const fmpz_mod_poly_oz_ntt_precomp_t precomp) {
+  const fmpz *q = fmpz_mod_poly_modulus(precomp->phi);
+  const size_t n = precomp->n;
+  const mp_size_t l = precomp->mont->nlimbs;
+
+  mp_limb_t acc[2*l+1];
+  mp_limb_t p[2*l];
+  mp_limb_t x[l];
+  mp_limb_t quo[l+2];
+  fmpz_t tmp;  fmpz_init(tmp);
+
+  mpn_zero(acc, 2*l+1);
+  for(size_t i=0; i<n; i++) {
+    if (!_mpn_oz_ntt_get_coeff(x, op, i, l, tmp, q))
+      continue;
+    mpn_mul_n(p, x, row + i*l, l);
+    acc[2*l] += mpn_add_n(acc, acc, p, 2*l);
+  }
+  fmpz_clear(tmp);
+
+  mp_size_t s = 2*l+1;
+  while (s > 0 && acc[s-1] == 0)
+    s--;
+  if (s >= l) {
+    mpn_tdiv_qr(quo, x, 0, acc, s, precomp->mont->q, l);
+    _fmpz_oz_set_mpn(rop, x, l);
+  } else {
+    _fmpz_oz_set_mpn(rop, acc, s);
   }
 }
 
@@ -293,7 +1355,7 @@ void _fmpz_mod_poly_oz_mul_nttnwc(fmpz_mod_poly_t h, const fmpz_mod_poly_t f, co
   fmpz_mod_poly_oz_ntt_enc(F, f, precomp);
   fmpz_mod_poly_oz_ntt_enc(G, g, precomp);
 
-  fmpz_mod_poly_oz_ntt_mul(h, F, G, n);
+  _fmpz_mod_poly_oz_ntt_mul(h, F, G, precomp);
 
   fmpz_mod_poly_clear(F);
   fmpz_mod_poly_clear(G);
@@ -306,11 +1368,8 @@ void fmpz_mod_poly_oz_mul_nttnwc(fmpz_mod_poly_t h, const fmpz_mod_poly_t f, con
   assert(fmpz_mod_poly_length(f) == fmpz_mod_poly_length(g));
   assert(fmpz_mod_poly_length(f) == (long)n);
 
-  const fmpz *q = fmpz_mod_poly_modulus(f);
-  fmpz_mod_poly_oz_ntt_precomp_t precomp;
-  fmpz_mod_poly_oz_ntt_precomp_init(precomp, n, q);
-
+  const struct fmpz_mod_poly_oz_ntt_precomp_struct *precomp =
+    fmpz_mod_poly_oz_ntt_precomp_get(n, fmpz_mod_poly_modulus(f));
   _fmpz_mod_poly_oz_mul_nttnwc(h, f, g, precomp);
-
-  fmpz_mod_poly_oz_ntt_precomp_clear(precomp);
+  fmpz_mod_poly_oz_ntt_precomp_put(precomp);
 }
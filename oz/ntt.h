@@ -9,6 +9,11 @@
    \mbox{NTT}_{ω_n}^{-1}(\mbox{NTT}_{ω_n}(\overline{a}) \odot \mbox{NTT}_{ω_n}(\overline{b}))@f$
    where @f$\mbox{NTT}_{ω_n}(·)@f$ is the number-theoretic transform and
    @f$\mbox{NTT}_{ω_n}^{-1}(·)@f$ is its inverse.
+
+   @note The functions taking a @ref fmpz_mod_poly_oz_ntt_precomp_t merge the twist by $φ^i$ into
+   the transform and return @f$\NTT{a}@f$ in bit-reversed order, i.e. slot $i$ holds
+   @f$a(φ^{2·\mbox{rev}(i)+1})@f$. This order is irrelevant for slot-wise arithmetic but differs
+   from the natural order returned by @ref fmpz_mod_poly_oz_ntt.
  */
 
 #ifndef NTT_H
@@ -16,19 +21,61 @@
 
 #include <stdint.h>
 #include <stdio.h>
+#include <omp.h>
 #include <mpfr.h>
 #include <flint/fmpz_mod_poly.h>
+#include <oz/flags.h>
+#include <oz/mont.h>
+
+/**
+   @brief Bytes of coefficient data a thread processes in one go in each stage of the transforms.
+
+   Each stage of @ref _mpn_oz_ntt_enc and @ref _mpn_oz_ntt_dec is split into blocks of butterflies
+   touching about this many bytes, blocks are distributed among threads. Transforms with fewer than
+   two blocks per stage are computed by the calling thread only.
+*/
+
+#define OZ_NTT_BLOCK_BYTES 16384
+
+/**
+   @brief Bytes of coefficient data the four-step transforms aim to keep in cache, about the size of L2.
+
+   Elements larger than this are transformed as an @f$n_1 × n_2@f$ matrix with @f$n_1 ≈ \sqrt{n}@f$:
+   first all stages combining entries of the same column, a few columns at a time, then all stages
+   combining entries of the same row, one row at a time. The result is the same as for the radix-2
+   transforms but memory is traversed twice instead of $\\log_2 n$ times.
+*/
+
+#define OZ_NTT_CACHE_BYTES (1<<20)
 
 /**
    @brief Pre-computed data for number-theoretic transform
+
+   Besides the power tables as polynomials we store the twiddle factors of the merged transforms in
+   Montgomery representation as flat limb arrays, i.e. entry $i$ occupies limbs $i·\\ell, …,
+   (i+1)·\\ell-1$ where $\\ell$ is the number of limbs of $q$. These are used by the transforms and
+   products below which thus avoid divisions. The inverse transforms use
+   $φ^{-\\mbox{rev}(m+i)} = -φ^{\\mbox{rev}(2m-1-i)}$ for $0 ≤ i < m$, i.e. the forward twiddles with
+   reversed index within each stage, so no inverse tables are stored.
+
+   If `OZ_NTT_COMPACT` is set, `w` is empty and `phi` only holds $1, φ$. If `OZ_NTT_SEEDED` is set,
+   `phi_rev_mont` is `NULL` and each twiddle factor is computed with one Montgomery multiplication
+   as $φ^{e} = φ^{e_0}·φ^{2^b e_1}$ from the two tables in `phi_seed_mont` when needed.
 */
 
 struct fmpz_mod_poly_oz_ntt_precomp_struct {
   size_t n;                   //!< dimension, must be a  power of two
-  fmpz_mod_poly_t w;          //!< a vector holding $ω_n^i$ at index $i$ where $ω_n$ as an $n$-th root of unity.
-  fmpz_mod_poly_t w_inv;      //!< a vector holding $ω_n^{-i}$ at index $i$ where $ω_n$ as an $n$-th root of unity.
-  fmpz_mod_poly_t phi;        //!< a vector holding $φ^i$ at index $i$ where @f$φ = \sqrt{ω_n} \bmod q@f$.
-  fmpz_mod_poly_t phi_inv;    //!< a vector holding $φ^{-i}$ at index $i$ where @f$φ = \sqrt{ω_n} \bmod q@f$.
+  fmpz_mod_poly_t w;          //!< a vector holding $ω_n^i$ at index $i$ where $ω_n$ as an $n$-th root of unity, empty if `OZ_NTT_COMPACT`
+  fmpz_mod_poly_t phi;        //!< a vector holding $φ^i$ at index $i$ where @f$φ = \sqrt{ω_n} \bmod q@f$, only $i < 2$ if `OZ_NTT_COMPACT`
+  fmpz_oz_mont_t mont;        //!< Montgomery data for $q$
+  mp_srcptr phi_rev_mont;     //!< $φ^{\\mbox{rev}(i)}·R \\bmod q$ at index $i$, i.e. in the order used by @ref _mpn_oz_ntt_enc, `NULL` if `OZ_NTT_SEEDED`
+  mp_srcptr phi_seed_mont;    //!< $φ^{e_0}·R$ for $e_0 < 2^b$ followed by $φ^{2^b e_1}·R$ for $e_1 < n/2^b$ if `OZ_NTT_SEEDED`, `NULL` otherwise
+  size_t seed_bits;           //!< $b = \\lfloor \\log_2(n)/2 \\rfloor$ if `OZ_NTT_SEEDED`
+  mp_srcptr n_inv_mont;       //!< $n^{-1}·R$ and $n^{-1}·φ^{-n/2}·R \\bmod q$ for the last stage of @ref _mpn_oz_ntt_dec
+  int nthreads;               //!< maximum number of threads used by a single call taking this pre-computation
+  size_t four_step;           //!< use the four-step transforms if $n ≥$ `four_step`, cf. `OZ_NTT_CACHE_BYTES`
+  mp_ptr tables;              //!< block holding `n_inv_mont` followed by the twiddle table, `NULL` if `borrowed`
+  int borrowed;               //!< `phi_rev_mont`, `phi_seed_mont` and `n_inv_mont` are owned by the caller, cf. @ref fmpz_mod_poly_oz_ntt_precomp_init_tables
 };
 
 /**
@@ -43,14 +90,152 @@ typedef struct fmpz_mod_poly_oz_ntt_precomp_struct fmpz_mod_poly_oz_ntt_precomp_
 
 void fmpz_mod_poly_oz_ntt_precomp_init(fmpz_mod_poly_oz_ntt_precomp_t op, const size_t n, const fmpz_t q);
 
+/**
+   @brief Pre-compute NTT data for $\\ZZ_q[x]/\\ideal{x^n+1}$ storing only the tables selected by `flags`.
+
+   With `OZ_NTT_COMPACT` the pre-computation takes $n$ instead of $3n$ elements of $\\ZZ_q$, with
+   `OZ_NTT_COMPACT | OZ_NTT_SEEDED` it takes $O(\\sqrt{n})$ elements at the cost of about one
+   additional multiplication per twiddle factor in each transform. Functions taking `op` work
+   unchanged, only direct access to `w` and `phi` is affected.
+*/
+
+void fmpz_mod_poly_oz_ntt_precomp_init_flags(fmpz_mod_poly_oz_ntt_precomp_t op, const size_t n, const fmpz_t q,
+                                             const oz_flag_t flags);
+
+/**
+   @brief Pre-compute NTT data for $\\ZZ_q[x]/\\ideal{x^n+1}$ where $q = \\prod p_i$.
+
+   The $2n$-th root of unity $φ$ is chosen as the CRT lift of roots $φ_i \\bmod p_i$, i.e. the
+   transform modulo $q$ agrees with the transform modulo each $p_i$ using $φ \\bmod p_i$.
+
+   @param op      uninitialised pre-computation
+   @param n       dimension, must be a power of two
+   @param primes  distinct word-sized primes with $p_i \\equiv 1 \\bmod 2n$
+   @param k       number of primes
+*/
+
+void fmpz_mod_poly_oz_ntt_precomp_init_crt(fmpz_mod_poly_oz_ntt_precomp_t op, const size_t n,
+                                           const mp_limb_t *primes, const size_t k);
+
+/**
+   @brief As @ref fmpz_mod_poly_oz_ntt_precomp_init_crt storing only the tables selected by `flags`,
+   cf. @ref fmpz_mod_poly_oz_ntt_precomp_init_flags.
+*/
+
+void fmpz_mod_poly_oz_ntt_precomp_init_crt_flags(fmpz_mod_poly_oz_ntt_precomp_t op, const size_t n,
+                                                 const mp_limb_t *primes, const size_t k, const oz_flag_t flags);
+
+/**
+   @brief Pre-compute NTT data for $\\ZZ_q[x]/\\ideal{x^n+1}$ from a known primitive $2n$-th root of
+   unity $φ$, cf. @ref fmpz_mod_poly_oz_ntt_precomp_get_root.
+
+   This skips the search for $φ$, the remaining work is linear in $n$. Transforms agree with those
+   of the pre-computation $φ$ was taken from.
+*/
+
+void fmpz_mod_poly_oz_ntt_precomp_init_root(fmpz_mod_poly_oz_ntt_precomp_t op, const size_t n, const fmpz_t q,
+                                            const fmpz_t phi, const oz_flag_t flags);
+
+/**
+   @brief Set `rop` to the primitive $2n$-th root of unity $φ$ used by `op`.
+*/
+
+static inline void fmpz_mod_poly_oz_ntt_precomp_get_root(fmpz_t rop, const fmpz_mod_poly_oz_ntt_precomp_t op) {
+  if (op->n > 1)
+    fmpz_set(rop, op->phi->coeffs + 1);
+  else
+    fmpz_sub_ui(rop, fmpz_mod_poly_modulus(op->phi), 1);
+}
+
 /**
    @brief Clear pre-computed data.
 */
 
 void fmpz_mod_poly_oz_ntt_precomp_clear(fmpz_mod_poly_oz_ntt_precomp_t op);
 
+/**
+   @brief Return the number of limbs written by @ref fmpz_mod_poly_oz_ntt_precomp_get_tables for a
+   pre-computation of dimension $n$ modulo $q$ with `nlimbs` limbs built with `flags`.
+*/
+
+size_t fmpz_mod_poly_oz_ntt_precomp_tables_size(const size_t n, const mp_size_t nlimbs, const oz_flag_t flags);
+
+/**
+   @brief Write `n_inv_mont` followed by `phi_seed_mont` if set or `phi_rev_mont` otherwise to `rop`.
+*/
+
+void fmpz_mod_poly_oz_ntt_precomp_get_tables(mp_ptr rop, const fmpz_mod_poly_oz_ntt_precomp_t op);
+
+/**
+   @brief Initialise `op` to use tables written by @ref fmpz_mod_poly_oz_ntt_precomp_get_tables in place.
+
+   Nothing is computed or copied except the Montgomery data for $q$ and the compact `phi`, i.e. `op`
+   behaves as if built with `OZ_NTT_COMPACT` added to `flags`. The tables at `tables` are only read,
+   e.g. they may live in a read-only shared mapping, and must outlive `op`.
+
+   @param flags  must agree in `OZ_NTT_SEEDED` with the pre-computation the tables were taken from
+*/
+
+void fmpz_mod_poly_oz_ntt_precomp_init_tables(fmpz_mod_poly_oz_ntt_precomp_t op, const size_t n, const fmpz_t q,
+                                              const fmpz_t phi, mp_srcptr tables, const oz_flag_t flags);
+
+/**
+   @brief Return the process-wide pre-computation for $\\ZZ_q[x]/\\ideal{x^n+1}$.
+
+   Pre-computations are built on first use and shared by all callers asking for the same $(n,q)$.
+   Each call must be matched by a call to @ref fmpz_mod_poly_oz_ntt_precomp_put, the returned data
+   must not be modified. Safe to call from several threads.
+*/
+
+const struct fmpz_mod_poly_oz_ntt_precomp_struct *fmpz_mod_poly_oz_ntt_precomp_get(const size_t n, const fmpz_t q);
+
+/**
+   @brief Release a reference obtained from @ref fmpz_mod_poly_oz_ntt_precomp_get.
+
+   The pre-computation stays cached until @ref fmpz_mod_poly_oz_ntt_precomp_cache_clear.
+*/
+
+void fmpz_mod_poly_oz_ntt_precomp_put(const struct fmpz_mod_poly_oz_ntt_precomp_struct *op);
+
+/**
+   @brief Free all cached pre-computations which are not referenced.
+
+   @return number of pre-computations still referenced and thus kept
+*/
+
+size_t fmpz_mod_poly_oz_ntt_precomp_cache_clear(void);
+
+/**
+   @brief Set the maximum number of threads used by a single call taking `op`.
+
+   Pre-computations start with `omp_get_max_threads()`. Calls made from within an active parallel
+   region, e.g. by callers which parallelise across many elements themselves, use one thread
+   regardless, cf. @ref _fmpz_mod_poly_oz_ntt_nthreads.
+*/
+
+static inline void fmpz_mod_poly_oz_ntt_precomp_set_nthreads(fmpz_mod_poly_oz_ntt_precomp_t op, const int nthreads) {
+  op->nthreads = (nthreads > 0) ? nthreads : 1;
+}
+
+/**
+   @brief Return the number of threads to use for a single call on $n$ coefficients.
+
+   This is 1 if an element spans fewer than two blocks of `OZ_NTT_BLOCK_BYTES` or if called from
+   within an active parallel region, so that kernels called per element of a parallel loop do not
+   open nested teams of `op->nthreads` threads each.
+*/
+
+static inline int _fmpz_mod_poly_oz_ntt_nthreads(const fmpz_mod_poly_oz_ntt_precomp_t op) {
+  if (omp_in_parallel())
+    return 1;
+  const size_t bytes = op->n * op->mont->nlimbs * sizeof(mp_limb_t);
+  return (bytes >= 2*OZ_NTT_BLOCK_BYTES) ? op->nthreads : 1;
+}
+
 /**
    @brief Compute @f$\mbox{rop} = \NTT{\mbox{op}}@f$.
+
+   If $2n | q-1$ the powers of $ω_n$ are taken from @ref fmpz_mod_poly_oz_ntt_precomp_get.
 */
 
 void fmpz_mod_poly_oz_ntt (fmpz_mod_poly_t rop, const fmpz_mod_poly_t op, const size_t n);
@@ -79,6 +264,30 @@ void fmpz_mod_poly_oz_ntt_enc_fmpz_poly(fmpz_mod_poly_t rop, const fmpz_poly_t o
 
 void fmpz_mod_poly_oz_ntt_dec(fmpz_mod_poly_t rop, const fmpz_mod_poly_t op, const fmpz_mod_poly_oz_ntt_precomp_t precomp);
 
+/**
+   @brief Write the row of the inverse transform producing coefficient $j$ to `row`.
+
+   Entry $i$ of `row` occupies limbs $i·\\ell, …, (i+1)·\\ell-1$ and is set such that $j$-th
+   coefficient of @f$\INTT{A}@f$ is @f$\sum_i \mbox{row}_i·A_i \bmod q@f$. If `f` is not `NULL` the row
+   is multiplied slot-wise by `f`, i.e. it computes the $j$-th coefficient of @f$\INTT{f \odot A}@f$.
+
+   @param row    array of $n·\\ell$ limbs
+*/
+
+void _fmpz_mod_poly_oz_ntt_dec_row(mp_ptr row, const size_t j, const fmpz_mod_poly_t f,
+                                   const fmpz_mod_poly_oz_ntt_precomp_t precomp);
+
+/**
+   @brief Compute a single coefficient of @f$\INTT{\mbox{op}}@f$ in $O(n)$ from a row computed by
+   @ref _fmpz_mod_poly_oz_ntt_dec_row.
+
+   Products are accumulated in $2\\ell+1$ limbs and reduced modulo $q$ once. `op` may be lazily
+   reduced.
+*/
+
+void _fmpz_mod_poly_oz_ntt_dec_coeff(fmpz_t rop, const fmpz_mod_poly_t op, mp_srcptr row,
+                                     const fmpz_mod_poly_oz_ntt_precomp_t precomp);
+
 /**
    @brief Compute @f$\mbox{rop} = \NTT{c}@f$ using `precomp`.
 */
@@ -97,24 +306,134 @@ void fmpz_mod_poly_oz_ntt_set_ui(fmpz_mod_poly_t rop, const unsigned long c, con
 
 void fmpz_mod_poly_oz_ntt_mul(fmpz_mod_poly_t h, const fmpz_mod_poly_t f, const fmpz_mod_poly_t g, const size_t n);
 
+/**
+   @brief Compute $h = \\NTT{f' · g'}$ from $f = \\NTT{f'}$ and $g = \\NTT{g'}$ using `precomp`.
+
+   @note Uses Montgomery multiplication, i.e. no division is performed.
+*/
+
+void _fmpz_mod_poly_oz_ntt_mul(fmpz_mod_poly_t h, const fmpz_mod_poly_t f, const fmpz_mod_poly_t g,
+                               const fmpz_mod_poly_oz_ntt_precomp_t precomp);
+
+/**
+   @brief Compute $h = \\prod_{j<\\mbox{len}} f_j$ in the NTT domain using `precomp`.
+
+   Each slot accumulates its running product with one Montgomery multiplication per factor, the
+   $R^{-\\mbox{len}}$ this introduces is cancelled by scaling the first factor. Slots are independent
+   and distributed among threads. `h` may alias any input and is set to one if `len` is zero.
+*/
+
+void _fmpz_mod_poly_oz_ntt_mul_many(fmpz_mod_poly_t h, fmpz_mod_poly_t *f, const size_t len,
+                                    const fmpz_mod_poly_oz_ntt_precomp_t precomp);
+
+/**
+   @brief Compute $h = h + f·g$ in the NTT domain using `precomp`, reducing modulo $q$ once.
+
+   The product is added to $h$ before reduction, i.e. this costs one multiplication and one
+   division per slot instead of two Montgomery reductions and a modular addition.
+*/
+
+void _fmpz_mod_poly_oz_ntt_addmul(fmpz_mod_poly_t h, const fmpz_mod_poly_t f, const fmpz_mod_poly_t g,
+                                  const fmpz_mod_poly_oz_ntt_precomp_t precomp);
+
+/**
+   @brief Compute $h = \\sum_{j<\\mbox{len}} f_j·g_j$ in the NTT domain using `precomp`, reducing modulo $q$ once.
+
+   Products are accumulated in $2\\ell+1$ limbs per slot, hence up to $2^w$ terms are supported. `h`
+   may alias any input.
+*/
+
+void _fmpz_mod_poly_oz_ntt_dot(fmpz_mod_poly_t h, fmpz_mod_poly_t *f, fmpz_mod_poly_t *g, const size_t len,
+                               const fmpz_mod_poly_oz_ntt_precomp_t precomp);
+
+/**
+   @brief Compute $h = f+g$ without reducing modulo $q$.
+
+   If $f_i ∈ [0, k_f q)$ and $g_i ∈ [0, k_g q)$ then $h_i ∈ [0, (k_f+k_g) q)$. Such lazily reduced
+   elements are accepted by @ref _fmpz_mod_poly_oz_ntt_mul, @ref _fmpz_mod_poly_oz_ntt_addmul,
+   @ref _fmpz_mod_poly_oz_ntt_dot, @ref _fmpz_mod_poly_oz_ntt_pow_ui and
+   @ref fmpz_mod_poly_oz_ntt_dec, which all return reduced elements. They must not be passed to
+   other `fmpz_mod_poly` functions. The length of $h$ is $n$, it is not normalised.
+*/
+
+void _fmpz_mod_poly_oz_ntt_add_lazy(fmpz_mod_poly_t h, const fmpz_mod_poly_t f, const fmpz_mod_poly_t g,
+                                    const fmpz_mod_poly_oz_ntt_precomp_t precomp);
+
+/**
+   @brief Compute $h = f-g$ without reducing modulo $q$.
+
+   Negative slots are lifted by adding $q$ until they are non-negative, i.e. if $f_i ∈ [0, k_f q)$
+   then $h_i ∈ [0, k_f q)$. This takes at most $k_g$ additions if $g_i ∈ [0, k_g q)$.
+
+   @see _fmpz_mod_poly_oz_ntt_add_lazy
+*/
+
+void _fmpz_mod_poly_oz_ntt_sub_lazy(fmpz_mod_poly_t h, const fmpz_mod_poly_t f, const fmpz_mod_poly_t g,
+                                    const fmpz_mod_poly_oz_ntt_precomp_t precomp);
+
 /**
    @brief Compute $h = \\NTT{f'^{-1}}$  where $f' \\in \\ZZ_q[x]/\\ideal{x^n+1}$ from $f = \\NTT{f'}$.
 */
 
 void fmpz_mod_poly_oz_ntt_inv(fmpz_mod_poly_t h, const fmpz_mod_poly_t f, const size_t n);
 
+/**
+   @brief Compute $h_j = \\NTT{f_j'^{-1}}$ for all $j < \\mbox{len}$ from $f_j = \\NTT{f_j'}$ using `precomp`.
+
+   Uses Montgomery's trick: one modular inversion for all $\\mbox{len}·n$ coefficients and three
+   Montgomery multiplications per coefficient, split into one chunk per thread. Zero coefficients
+   are skipped and map to zero. `h[j]` must not alias any `f[i]`.
+*/
+
+void _fmpz_mod_poly_oz_ntt_inv_many(fmpz_mod_poly_t *h, fmpz_mod_poly_t *f, const size_t len,
+                                    const fmpz_mod_poly_oz_ntt_precomp_t precomp);
+
 /**
    @brief Compute $h = \\NTT{f'^e}$  where $f' \\in \\ZZ_q[x]/\\ideal{x^n+1}$ from $f = \\NTT{f'}$.
 */
 
 void fmpz_mod_poly_oz_ntt_pow_ui(fmpz_mod_poly_t h, const fmpz_mod_poly_t f, unsigned long e, const size_t n);
 
+/**
+   @brief Compute $h = \\NTT{f'^e}$  where $f' \\in \\ZZ_q[x]/\\ideal{x^n+1}$ from $f = \\NTT{f'}$ using `precomp`.
+*/
+
+void _fmpz_mod_poly_oz_ntt_pow_ui(fmpz_mod_poly_t h, const fmpz_mod_poly_t f, unsigned long e,
+                                  const fmpz_mod_poly_oz_ntt_precomp_t precomp);
+
 /**
    @brief Perform $\\mbox{rop} = \\NTT{\\mbox{op}}$ given $w = (1,ω,ω^2,…,ω^{n-1})$.
 */
 
 void _fmpz_mod_poly_oz_ntt(fmpz_mod_poly_t rop, const fmpz_mod_poly_t op, const fmpz_mod_poly_t w, const size_t n);
 
+/**
+   @brief Compute @f$\NTT{a}@f$ in place on a flat limb array using `precomp`.
+
+   @param a        $n·\\ell$ limbs, input in natural order, output in bit-reversed order
+   @param precomp  NTT pre-computation for $q$
+
+   The twist by $φ^i$ is merged into the butterflies, hence no separate pass or permutation is
+   needed. Multiplications by twiddles are Montgomery multiplications by $c·R$, hence the transform
+   maps elements in Montgomery representation to elements in Montgomery representation and plain
+   elements to plain elements. No memory is allocated, scratch space lives on the stack of each
+   thread. Up to `precomp->nthreads` threads are used.
+*/
+
+void _mpn_oz_ntt_enc(mp_ptr a, const fmpz_mod_poly_oz_ntt_precomp_t precomp);
+
+/**
+   @brief Compute @f$\INTT{a}@f$ in place on a flat limb array using `precomp`.
+
+   @param a        $n·\\ell$ limbs, input in bit-reversed order, output in natural order
+   @param precomp  NTT pre-computation for $q$
+
+   The twist by $φ^{-i}$ and the factor $1/n$ are merged into the butterflies. No memory is
+   allocated. Up to `precomp->nthreads` threads are used.
+*/
+
+void _mpn_oz_ntt_dec(mp_ptr a, const fmpz_mod_poly_oz_ntt_precomp_t precomp);
+
 /**
    @brief Compute $h = f · g$ using the number-theoretic transform using `precomp`.
 */
@@ -123,6 +442,8 @@ void _fmpz_mod_poly_oz_mul_nttnwc(fmpz_mod_poly_t h, const fmpz_mod_poly_t f, co
 
 /**
    @brief Compute $h = f · g$ using the number-theoretic transform.
+
+   Uses the cached pre-computation from @ref fmpz_mod_poly_oz_ntt_precomp_get.
 */
 
 void fmpz_mod_poly_oz_mul_nttnwc(fmpz_mod_poly_t h, const fmpz_mod_poly_t f, const fmpz_mod_poly_t g, const size_t n);
@@ -0,0 +1,273 @@
+#include <assert.h>
+#include <omp.h>
+#include "rns.h"
+#include "util.h"
+
+/**
+   Same transform as `_mpn_oz_ntt_enc` but modulo a word-sized prime, in place.
+*/
+
+static void _nmod_vec_oz_rns_ntt_enc(mp_ptr a, mp_srcptr phi_rev, const size_t n, const nmod_t mod) {
+  for(size_t m=1, s=n/2; m<n; m*=2, s/=2) {
+    for(size_t i=0; i<m; i++) {
+      const mp_limb_t c = phi_rev[m+i];
+      mp_ptr x = a + 2*i*s;
+      mp_ptr y = x + s;
+      for(size_t j=0; j<s; j++) {
+        const mp_limb_t v = n_mulmod2_preinv(y[j], c, mod.n, mod.ninv);
+        y[j] = n_submod(x[j], v, mod.n);
+        x[j] = n_addmod(x[j], v, mod.n);
+      }
+    }
+  }
+}
+
+/**
+   Same transform as `_mpn_oz_ntt_dec` but modulo a word-sized prime, in place.
+*/
+
+static void _nmod_vec_oz_rns_ntt_dec(mp_ptr a, mp_srcptr phi_inv_rev, mp_srcptr n_inv, const size_t n, const nmod_t mod) {
+  if (n == 1)
+    return;
+
+  for(size_t m=n, s=1; m>2; m/=2, s*=2) {
+    for(size_t i=0; i<m/2; i++) {
+      const mp_limb_t c = phi_inv_rev[m/2+i];
+      mp_ptr x = a + 2*i*s;
+      mp_ptr y = x + s;
+      for(size_t j=0; j<s; j++) {
+        const mp_limb_t v = n_submod(x[j], y[j], mod.n);
+        x[j] = n_addmod(x[j], y[j], mod.n);
+        y[j] = n_mulmod2_preinv(v, c, mod.n, mod.ninv);
+      }
+    }
+  }
+
+  mp_ptr x = a;
+  mp_ptr y = a + n/2;
+  for(size_t j=0; j<n/2; j++) {
+    const mp_limb_t v = n_submod(x[j], y[j], mod.n);
+    x[j] = n_mulmod2_preinv(n_addmod(x[j], y[j], mod.n), n_inv[0], mod.n, mod.ninv);
+    y[j] = n_mulmod2_preinv(v, n_inv[1], mod.n, mod.ninv);
+  }
+}
+
+void fmpz_mod_poly_oz_rns_precomp_init(fmpz_mod_poly_oz_rns_precomp_t op, const fmpz_mod_poly_oz_ntt_precomp_t ntt,
+                                       const mp_limb_t *primes, const size_t k) {
+  const size_t n = ntt->n;
+  assert(n >= 2);
+
+  op->n = n;
+  op->k = k;
+  op->primes = (mp_limb_t*)malloc(k * sizeof(mp_limb_t));
+  op->mod = (nmod_t*)malloc(k * sizeof(nmod_t));
+  op->phi_rev     = _nmod_vec_init(k*n);
+  op->phi_inv_rev = _nmod_vec_init(k*n);
+  op->n_inv       = _nmod_vec_init(2*k);
+
+  fmpz_init_set_ui(op->q, 1);
+
+  for(size_t i=0; i<k; i++) {
+    op->primes[i] = primes[i];
+    nmod_init(op->mod + i, primes[i]);
+    fmpz_mul_ui(op->q, op->q, primes[i]);
+
+    /* reducing φ mod p_i guarantees that both transforms agree */
+    const mp_limb_t phi = fmpz_fdiv_ui(ntt->phi->coeffs + 1, primes[i]);
+    const mp_limb_t phi_inv = n_invmod(phi, primes[i]);
+    const size_t lg = n_flog(n, 2);
+    for(size_t j=0; j<n; j++) {
+      const mp_limb_t e = n_revbin(j, lg);
+      op->phi_rev[i*n + j]     = n_powmod2_preinv(phi,     e, op->mod[i].n, op->mod[i].ninv);
+      op->phi_inv_rev[i*n + j] = n_powmod2_preinv(phi_inv, e, op->mod[i].n, op->mod[i].ninv);
+    }
+
+    /** @note We fold 1/n into the last stage of the inverse transform **/
+    op->n_inv[2*i+0] = n_invmod(n % primes[i], primes[i]);
+    op->n_inv[2*i+1] = n_mulmod2_preinv(op->n_inv[2*i+0], op->phi_inv_rev[i*n + 1], op->mod[i].n, op->mod[i].ninv);
+  }
+
+  if (!fmpz_equal(op->q, fmpz_mod_poly_modulus(ntt->phi)))
+    oz_die("q is not the product of the given primes");
+
+  fmpz_comb_init(op->comb, op->primes, k);
+  op->nthreads = ntt->nthreads;
+}
+
+void fmpz_mod_poly_oz_rns_precomp_clear(fmpz_mod_poly_oz_rns_precomp_t op) {
+  fmpz_comb_clear(op->comb);
+  fmpz_clear(op->q);
+  _nmod_vec_clear(op->n_inv);
+  _nmod_vec_clear(op->phi_inv_rev);
+  _nmod_vec_clear(op->phi_rev);
+  free(op->mod);
+  free(op->primes);
+}
+
+void fmpz_mod_poly_oz_rns_init(fmpz_mod_poly_oz_rns_t op, const fmpz_mod_poly_oz_rns_precomp_t precomp) {
+  op->n = precomp->n;
+  op->k = precomp->k;
+  op->coeffs = _nmod_vec_init(op->k * op->n);
+  _nmod_vec_zero(op->coeffs, op->k * op->n);
+}
+
+void fmpz_mod_poly_oz_rns_clear(fmpz_mod_poly_oz_rns_t op) {
+  _nmod_vec_clear(op->coeffs);
+  op->coeffs = NULL;
+}
+
+void fmpz_mod_poly_oz_rns_set_ui(fmpz_mod_poly_oz_rns_t rop, const unsigned long c, const fmpz_mod_poly_oz_rns_precomp_t precomp) {
+  const size_t n = precomp->n;
+  for(size_t i=0; i<precomp->k; i++) {
+    const mp_limb_t c_i = c % precomp->primes[i];
+    for(size_t j=0; j<n; j++)
+      rop->coeffs[i*n + j] = c_i;
+  }
+}
+
+void fmpz_mod_poly_oz_rns_set_fmpz_mod_poly(fmpz_mod_poly_oz_rns_t rop, const fmpz_mod_poly_t op,
+                                            const fmpz_mod_poly_oz_rns_precomp_t precomp) {
+  const size_t n = precomp->n;
+  const size_t k = precomp->k;
+
+#pragma omp parallel num_threads(_fmpz_mod_poly_oz_rns_nthreads(precomp))
+  {
+    fmpz_comb_temp_t temp;
+    fmpz_comb_temp_init(temp, precomp->comb);
+    mp_ptr r = _nmod_vec_init(k);
+
+#pragma omp for
+    for(size_t j=0; j<n; j++) {
+      if ((long)j < op->length) {
+        fmpz_multi_mod_ui(r, op->coeffs + j, precomp->comb, temp);
+      } else {
+        _nmod_vec_zero(r, k);
+      }
+      for(size_t i=0; i<k; i++)
+        rop->coeffs[i*n + j] = r[i];
+    }
+
+    _nmod_vec_clear(r);
+    fmpz_comb_temp_clear(temp);
+  }
+}
+
+void fmpz_mod_poly_oz_rns_get_fmpz_mod_poly(fmpz_mod_poly_t rop, const fmpz_mod_poly_oz_rns_t op,
+                                            const fmpz_mod_poly_oz_rns_precomp_t precomp) {
+  const size_t n = precomp->n;
+  const size_t k = precomp->k;
+  fmpz_mod_poly_realloc(rop, n);
+
+#pragma omp parallel num_threads(_fmpz_mod_poly_oz_rns_nthreads(precomp))
+  {
+    fmpz_comb_temp_t temp;
+    fmpz_comb_temp_init(temp, precomp->comb);
+    mp_ptr r = _nmod_vec_init(k);
+
+#pragma omp for
+    for(size_t j=0; j<n; j++) {
+      for(size_t i=0; i<k; i++)
+        r[i] = op->coeffs[i*n + j];
+      fmpz_multi_CRT_ui(rop->coeffs + j, r, precomp->comb, temp, 0);
+    }
+
+    _nmod_vec_clear(r);
+    fmpz_comb_temp_clear(temp);
+  }
+  rop->length = n;
+  _fmpz_mod_poly_normalise(rop);
+}
+
+void fmpz_mod_poly_oz_rns_enc_fmpz_poly(fmpz_mod_poly_oz_rns_t rop, const fmpz_poly_t op,
+                                        const fmpz_mod_poly_oz_rns_precomp_t precomp) {
+  const size_t n = precomp->n;
+  const size_t len = (op->length < (long)n) ? (size_t)op->length : n;
+
+#pragma omp parallel for num_threads(_fmpz_mod_poly_oz_rns_nthreads(precomp))
+  for(size_t i=0; i<precomp->k; i++) {
+    const nmod_t mod = precomp->mod[i];
+    mp_ptr a = rop->coeffs + i*n;
+
+    for(size_t j=0; j<len; j++)
+      a[j] = fmpz_fdiv_ui(op->coeffs + j, mod.n);
+    for(size_t j=len; j<n; j++)
+      a[j] = 0;
+    _nmod_vec_oz_rns_ntt_enc(a, precomp->phi_rev + i*n, n, mod);
+  }
+}
+
+void fmpz_mod_poly_oz_rns_dec_fmpz_poly(fmpz_poly_t rop, const fmpz_mod_poly_oz_rns_t op,
+                                        const fmpz_mod_poly_oz_rns_precomp_t precomp) {
+  const size_t n = precomp->n;
+  const size_t k = precomp->k;
+
+  /* residues of the result, transposed so that the residues of one coefficient are adjacent */
+  mp_ptr T = _nmod_vec_init(k*n);
+  mp_ptr A = _nmod_vec_init(k*n);
+  _nmod_vec_set(A, op->coeffs, k*n);
+
+#pragma omp parallel for num_threads(_fmpz_mod_poly_oz_rns_nthreads(precomp))
+  for(size_t i=0; i<k; i++) {
+    mp_ptr a = A + i*n;
+    _nmod_vec_oz_rns_ntt_dec(a, precomp->phi_inv_rev + i*n, precomp->n_inv + 2*i, n, precomp->mod[i]);
+    for(size_t j=0; j<n; j++)
+      T[j*k + i] = a[j];
+  }
+  _nmod_vec_clear(A);
+
+  fmpz_poly_fit_length(rop, n);
+
+#pragma omp parallel num_threads(_fmpz_mod_poly_oz_rns_nthreads(precomp))
+  {
+    fmpz_comb_temp_t temp;
+    fmpz_comb_temp_init(temp, precomp->comb);
+#pragma omp for
+    for(size_t j=0; j<n; j++)
+      fmpz_multi_CRT_ui(rop->coeffs + j, T + j*k, precomp->comb, temp, 1);
+    fmpz_comb_temp_clear(temp);
+  }
+
+  _fmpz_poly_set_length(rop, n);
+  _fmpz_poly_normalise(rop);
+  _nmod_vec_clear(T);
+}
+
+void fmpz_mod_poly_oz_rns_mul(fmpz_mod_poly_oz_rns_t h, const fmpz_mod_poly_oz_rns_t f, const fmpz_mod_poly_oz_rns_t g,
+                              const fmpz_mod_poly_oz_rns_precomp_t precomp) {
+  const size_t n = precomp->n;
+#pragma omp parallel for num_threads(_fmpz_mod_poly_oz_rns_nthreads(precomp))
+  for(size_t i=0; i<precomp->k; i++) {
+    const nmod_t mod = precomp->mod[i];
+    mp_ptr h_ = h->coeffs + i*n;
+    mp_srcptr f_ = f->coeffs + i*n;
+    mp_srcptr g_ = g->coeffs + i*n;
+    for(size_t j=0; j<n; j++)
+      h_[j] = n_mulmod2_preinv(f_[j], g_[j], mod.n, mod.ninv);
+  }
+}
+
+void fmpz_mod_poly_oz_rns_add(fmpz_mod_poly_oz_rns_t h, const fmpz_mod_poly_oz_rns_t f, const fmpz_mod_poly_oz_rns_t g,
+                              const fmpz_mod_poly_oz_rns_precomp_t precomp) {
+  const size_t n = precomp->n;
+  for(size_t i=0; i<precomp->k; i++) {
+    const mp_limb_t p = precomp->primes[i];
+    mp_ptr h_ = h->coeffs + i*n;
+    mp_srcptr f_ = f->coeffs + i*n;
+    mp_srcptr g_ = g->coeffs + i*n;
+    for(size_t j=0; j<n; j++)
+      h_[j] = n_addmod(f_[j], g_[j], p);
+  }
+}
+
+void fmpz_mod_poly_oz_rns_sub(fmpz_mod_poly_oz_rns_t h, const fmpz_mod_poly_oz_rns_t f, const fmpz_mod_poly_oz_rns_t g,
+                              const fmpz_mod_poly_oz_rns_precomp_t precomp) {
+  const size_t n = precomp->n;
+  for(size_t i=0; i<precomp->k; i++) {
+    const mp_limb_t p = precomp->primes[i];
+    mp_ptr h_ = h->coeffs + i*n;
+    mp_srcptr f_ = f->coeffs + i*n;
+    mp_srcptr g_ = g->coeffs + i*n;
+    for(size_t j=0; j<n; j++)
+      h_[j] = n_submod(f_[j], g_[j], p);
+  }
+}
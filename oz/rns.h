@@ -0,0 +1,173 @@
+/**
+   @file rns.h
+   @brief Computing in the NTT domain modulo a product of word-sized primes.
+
+   Let @f$q = \prod_{i=0}^{k-1} p_i@f$ where each @f$p_i \equiv 1 \bmod 2n@f$ is a word-sized prime
+   and let @f$φ@f$ be the @f$2n@f$-th root of unity used by @ref fmpz_mod_poly_oz_ntt_precomp_t.
+   Then @f$\NTT{a} \bmod p_i@f$ is the transform of @f$a \bmod p_i@f$ using @f$φ \bmod p_i@f$. We may
+   hence store an element of the NTT domain as a @f$k × n@f$ matrix of residues ("double-CRT") and
+   multiply, add and subtract row by row using single-word arithmetic. Lifting back to
+   @f$\ZZ_q@f$ is only required when the coefficients of the result are needed.
+*/
+
+#ifndef RNS_H
+#define RNS_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <omp.h>
+#include <flint/nmod_vec.h>
+#include <flint/fmpz_poly.h>
+#include <flint/fmpz_mod_poly.h>
+#include <oz/ntt.h>
+
+/**
+   @brief Bit size of primes @f$p_i@f$.
+*/
+
+#define OZ_RNS_PRIME_BITS 60
+
+/**
+   @brief Pre-computed data for computing modulo @f$q = \prod p_i@f$ in the NTT domain.
+*/
+
+struct fmpz_mod_poly_oz_rns_precomp_struct {
+  size_t n;           //!< dimension, must be a power of two
+  size_t k;           //!< number of primes
+  nmod_t *mod;        //!< primes $p_i$ with pre-computed inverses
+  mp_limb_t *primes;  //!< primes $p_i$
+  mp_ptr phi_rev;     //!< $φ^{\\mbox{rev}(j)} \\bmod p_i$ at index $i·n + j$
+  mp_ptr phi_inv_rev; //!< $φ^{-\\mbox{rev}(j)} \\bmod p_i$ at index $i·n + j$
+  mp_ptr n_inv;       //!< $n^{-1}$ and $n^{-1}·φ^{-n/2} \\bmod p_i$ at index $2i$ and $2i+1$
+  fmpz_t q;           //!< modulus $q = \\prod p_i$
+  fmpz_comb_t comb;   //!< product tree for multi-modular reduction and CRT
+  int nthreads;       //!< maximum number of threads used by a single call taking this pre-computation
+};
+
+typedef struct fmpz_mod_poly_oz_rns_precomp_struct fmpz_mod_poly_oz_rns_precomp_t[1];
+
+/**
+   @brief An element of the NTT domain modulo @f$q = \prod p_i@f$ stored as residues.
+*/
+
+struct fmpz_mod_poly_oz_rns_struct {
+  mp_ptr coeffs;  //!< $k × n$ residue matrix, row $i$ holds the NTT domain modulo $p_i$
+  size_t n;       //!< dimension
+  size_t k;       //!< number of primes
+};
+
+typedef struct fmpz_mod_poly_oz_rns_struct fmpz_mod_poly_oz_rns_t[1];
+
+/**
+   @brief Pre-compute RNS data compatible with `ntt`.
+
+   @param op      uninitialised pre-computation
+   @param ntt     NTT pre-computation for $q = \\prod p_i$, cf. @ref fmpz_mod_poly_oz_ntt_precomp_init_crt
+   @param primes  word-sized primes with $p_i \\equiv 1 \\bmod 2n$, at most `OZ_RNS_PRIME_BITS` bits
+   @param k       number of primes
+*/
+
+void fmpz_mod_poly_oz_rns_precomp_init(fmpz_mod_poly_oz_rns_precomp_t op, const fmpz_mod_poly_oz_ntt_precomp_t ntt,
+                                       const mp_limb_t *primes, const size_t k);
+
+/**
+   @brief Clear pre-computed RNS data.
+*/
+
+void fmpz_mod_poly_oz_rns_precomp_clear(fmpz_mod_poly_oz_rns_precomp_t op);
+
+/**
+   @brief Set the maximum number of threads used by a single call taking `op`.
+
+   The initial value is inherited from `ntt` in @ref fmpz_mod_poly_oz_rns_precomp_init.
+*/
+
+static inline void fmpz_mod_poly_oz_rns_precomp_set_nthreads(fmpz_mod_poly_oz_rns_precomp_t op, const int nthreads) {
+  op->nthreads = (nthreads > 0) ? nthreads : 1;
+}
+
+/**
+   @brief Return the number of threads to use for a single call, 1 within an active parallel region.
+*/
+
+static inline int _fmpz_mod_poly_oz_rns_nthreads(const fmpz_mod_poly_oz_rns_precomp_t op) {
+  return omp_in_parallel() ? 1 : op->nthreads;
+}
+
+/**
+   @brief Initialise `op` to zero.
+*/
+
+void fmpz_mod_poly_oz_rns_init(fmpz_mod_poly_oz_rns_t op, const fmpz_mod_poly_oz_rns_precomp_t precomp);
+
+/**
+   @brief Clear `op`.
+*/
+
+void fmpz_mod_poly_oz_rns_clear(fmpz_mod_poly_oz_rns_t op);
+
+/**
+   @brief Set `rop` to `op`.
+*/
+
+static inline void fmpz_mod_poly_oz_rns_set(fmpz_mod_poly_oz_rns_t rop, const fmpz_mod_poly_oz_rns_t op) {
+  if (rop != op)
+    _nmod_vec_set(rop->coeffs, op->coeffs, op->k * op->n);
+}
+
+/**
+   @brief Set `rop` to the constant $c$, i.e. to $c$ in every slot of the NTT domain.
+*/
+
+void fmpz_mod_poly_oz_rns_set_ui(fmpz_mod_poly_oz_rns_t rop, const unsigned long c, const fmpz_mod_poly_oz_rns_precomp_t precomp);
+
+/**
+   @brief Reduce an element of the NTT domain modulo $q$ to residues.
+*/
+
+void fmpz_mod_poly_oz_rns_set_fmpz_mod_poly(fmpz_mod_poly_oz_rns_t rop, const fmpz_mod_poly_t op,
+                                            const fmpz_mod_poly_oz_rns_precomp_t precomp);
+
+/**
+   @brief Lift residues to an element of the NTT domain modulo $q$.
+*/
+
+void fmpz_mod_poly_oz_rns_get_fmpz_mod_poly(fmpz_mod_poly_t rop, const fmpz_mod_poly_oz_rns_t op,
+                                            const fmpz_mod_poly_oz_rns_precomp_t precomp);
+
+/**
+   @brief Compute @f$\mbox{rop} = \NTT{\mbox{op}}@f$ for @f$\mbox{op} \in \ZZ[x]/\ideal{x^n+1}@f$.
+*/
+
+void fmpz_mod_poly_oz_rns_enc_fmpz_poly(fmpz_mod_poly_oz_rns_t rop, const fmpz_poly_t op,
+                                        const fmpz_mod_poly_oz_rns_precomp_t precomp);
+
+/**
+   @brief Compute @f$\mbox{rop} = \INTT{\mbox{op}}@f$ lifted to @f$(-q/2, q/2]@f$.
+*/
+
+void fmpz_mod_poly_oz_rns_dec_fmpz_poly(fmpz_poly_t rop, const fmpz_mod_poly_oz_rns_t op,
+                                        const fmpz_mod_poly_oz_rns_precomp_t precomp);
+
+/**
+   @brief Compute $h = f·g$ in the NTT domain.
+*/
+
+void fmpz_mod_poly_oz_rns_mul(fmpz_mod_poly_oz_rns_t h, const fmpz_mod_poly_oz_rns_t f, const fmpz_mod_poly_oz_rns_t g,
+                              const fmpz_mod_poly_oz_rns_precomp_t precomp);
+
+/**
+   @brief Compute $h = f+g$ in the NTT domain.
+*/
+
+void fmpz_mod_poly_oz_rns_add(fmpz_mod_poly_oz_rns_t h, const fmpz_mod_poly_oz_rns_t f, const fmpz_mod_poly_oz_rns_t g,
+                              const fmpz_mod_poly_oz_rns_precomp_t precomp);
+
+/**
+   @brief Compute $h = f-g$ in the NTT domain.
+*/
+
+void fmpz_mod_poly_oz_rns_sub(fmpz_mod_poly_oz_rns_t h, const fmpz_mod_poly_oz_rns_t f, const fmpz_mod_poly_oz_rns_t g,
+                              const fmpz_mod_poly_oz_rns_precomp_t precomp);
+
+#endif /* RNS_H */
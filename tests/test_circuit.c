@@ -0,0 +1,114 @@
+#include <gghlite/gghlite.h>
+
+int test_circuit(const size_t lambda, aes_randstate_t randstate) {
+
+    const size_t kappa = 2;
+    const size_t ninputs = 4;
+
+    printf("λ: %4zu, κ: %2zu …", lambda, kappa);
+
+    gghlite_sk_t self;
+    gghlite_init(self, lambda, kappa, 1, 0x0, GGHLITE_FLAGS_QUIET | GGHLITE_FLAGS_GOOD_G_INV, randstate);
+
+    fmpz_t p; fmpz_init(p);
+    fmpz_poly_oz_ideal_norm(p, self->g, self->params->n, 0);
+
+    gghlite_clr_t e;
+    gghlite_clr_init(e);
+    gghlite_enc_t u[ninputs];
+    int group[1] = {1};
+
+    for(size_t k=0; k<ninputs; k++) {
+        fmpz_t a;  fmpz_init(a);
+        fmpz_randm_aes(a, randstate, p);
+        fmpz_poly_zero(e);
+        fmpz_poly_set_coeff_fmpz(e, 0, a);
+        gghlite_enc_init(u[k], self->params);
+        gghlite_enc_set_gghlite_clr(u[k], self, e, 1, group, 1);
+        fmpz_clear(a);
+    }
+
+    gghlite_circuit_t c;
+    gghlite_circuit_init(c, ninputs);
+    size_t x[ninputs];
+    for(size_t k=0; k<ninputs; k++)
+        x[k] = gghlite_circuit_input(c, k);
+
+    int status = 0;
+
+    /* u_0·u_1 + u_2·u_3 */
+    const size_t m01 = gghlite_circuit_mul(c, x[0], x[1]);
+    const size_t m23 = gghlite_circuit_mul(c, x[2], x[3]);
+    gghlite_circuit_output(c, gghlite_circuit_add(c, m01, m23));
+
+    /* (u_0+u_2)·u_1 - u_0·u_1 - u_2·u_1 = 0 */
+    const size_t s = gghlite_circuit_mul(c, gghlite_circuit_add(c, x[0], x[2]), x[1]);
+    const size_t m21 = gghlite_circuit_mul(c, x[2], x[1]);
+    gghlite_circuit_output(c, gghlite_circuit_sub(c, gghlite_circuit_sub(c, s, m01), m21));
+
+    /* u_1·u_0 - u_0·u_1 = 0 */
+    const size_t m10 = gghlite_circuit_mul(c, x[1], x[0]);
+    if (m10 != m01)
+        status++;
+    gghlite_circuit_output(c, gghlite_circuit_sub(c, m10, m01));
+
+    /* (u_0-u_2)·(u_1+u_3) */
+    gghlite_circuit_output(c, gghlite_circuit_mul(c, gghlite_circuit_sub(c, x[0], x[2]),
+                                                  gghlite_circuit_add(c, x[1], x[3])));
+
+    gghlite_enc_t out[4];
+    for(size_t j=0; j<4; j++)
+        gghlite_enc_init(out[j], self->params);
+    gghlite_circuit_eval(out, self->params, c, u);
+
+    gghlite_enc_t t0, t1;
+    gghlite_enc_init(t0, self->params);
+    gghlite_enc_init(t1, self->params);
+
+    gghlite_enc_mul(t0, self->params, u[0], u[1]);
+    gghlite_enc_addmul(t0, self->params, u[2], u[3]);
+    if (!fmpz_mod_poly_equal(t0, out[0]))
+        status++;
+
+    gghlite_enc_sub(t0, self->params, u[0], u[2]);
+    gghlite_enc_add(t1, self->params, u[1], u[3]);
+    gghlite_enc_mul(t0, self->params, t0, t1);
+    if (!fmpz_mod_poly_equal(t0, out[3]))
+        status++;
+
+    int r[4];
+    gghlite_circuit_eval_is_zero(r, self->params, c, u);
+    if (r[0] != 0 || r[1] != 1 || r[2] != 1 || r[3] != 0)
+        status++;
+
+    gghlite_enc_clear(t1);
+    gghlite_enc_clear(t0);
+    for(size_t j=0; j<4; j++)
+        gghlite_enc_clear(out[j]);
+    gghlite_circuit_clear(c);
+    for(size_t k=0; k<ninputs; k++)
+        gghlite_enc_clear(u[k]);
+    gghlite_clr_clear(e);
+    fmpz_clear(p);
+    gghlite_sk_clear(self, 1);
+
+    if (status == 0)
+        printf(" PASS\n");
+    else
+        printf(" FAIL\n");
+
+    return status;
+}
+
+int main(int argc, char *argv[]) {
+    aes_randstate_t randstate;
+    aes_randinit(randstate);
+
+    int status = 0;
+    status += test_circuit(20, randstate);
+
+    aes_randclear(randstate);
+    flint_cleanup();
+    mpfr_free_cache();
+    return status;
+}
@@ -0,0 +1,130 @@
+#include <oz/oz.h>
+#include <oz/util.h>
+#include <oz/flint-addons.h>
+
+int test_fmpz_mod_poly_oz_ntt_dot(long n, mp_bitcnt_t bits, size_t len, aes_randstate_t state) {
+
+  fmpz_t q;
+  fmpz_init(q);
+  fmpz_randbits_aes(q, state, bits);
+  fmpz_abs(q, q);
+  fmpz_fdiv_q_2exp(q, q, n_flog(n,2)+1);
+  fmpz_mul_2exp(q, q, n_flog(n,2)+1);
+  fmpz_add_ui(q, q, 1);
+  while (!fmpz_is_probabprime(q))
+    fmpz_add_ui(q, q, 2*n);
+
+  fmpz_mod_poly_oz_ntt_precomp_t precomp;
+  fmpz_mod_poly_oz_ntt_precomp_init(precomp, n, q);
+
+  fmpz_mod_poly_t *f = (fmpz_mod_poly_t*)calloc(len, sizeof(fmpz_mod_poly_t));
+  fmpz_mod_poly_t *g = (fmpz_mod_poly_t*)calloc(len, sizeof(fmpz_mod_poly_t));
+  for(size_t j=0; j<len; j++) {
+    fmpz_mod_poly_init(f[j], q);
+    fmpz_mod_poly_init(g[j], q);
+    fmpz_mod_poly_randtest_aes(f[j], state, n);
+    fmpz_mod_poly_randtest_aes(g[j], state, n);
+  }
+
+  /* reference result */
+  fmpz_mod_poly_t r0;  fmpz_mod_poly_init(r0, q);
+  fmpz_mod_poly_t t;   fmpz_mod_poly_init(t, q);
+  for(size_t j=0; j<len; j++) {
+    _fmpz_mod_poly_oz_ntt_mul(t, f[j], g[j], precomp);
+    fmpz_mod_poly_add(r0, r0, t);
+  }
+
+  fmpz_mod_poly_t r1;  fmpz_mod_poly_init(r1, q);
+  _fmpz_mod_poly_oz_ntt_dot(r1, f, g, len, precomp);
+  int r = fmpz_mod_poly_equal(r0, r1);
+
+  fmpz_mod_poly_zero(r1);
+  for(size_t j=0; j<len; j++)
+    _fmpz_mod_poly_oz_ntt_addmul(r1, f[j], g[j], precomp);
+  r &= fmpz_mod_poly_equal(r0, r1);
+
+  /* (Σ f_j - g_0)·g_0 with lazy additions */
+  fmpz_mod_poly_zero(t);
+  for(size_t j=0; j<len; j++)
+    _fmpz_mod_poly_oz_ntt_add_lazy(t, t, f[j], precomp);
+  _fmpz_mod_poly_oz_ntt_sub_lazy(t, t, g[0], precomp);
+  _fmpz_mod_poly_oz_ntt_mul(r1, t, g[0], precomp);
+
+  fmpz_mod_poly_zero(t);
+  for(size_t j=0; j<len; j++)
+    fmpz_mod_poly_add(t, t, f[j]);
+  fmpz_mod_poly_sub(t, t, g[0]);
+  _fmpz_mod_poly_oz_ntt_mul(r0, t, g[0], precomp);
+  r &= fmpz_mod_poly_equal(r0, r1);
+
+  /* Π f_j */
+  fmpz_mod_poly_oz_ntt_set_ui(r0, 1, n);
+  for(size_t j=0; j<len; j++)
+    _fmpz_mod_poly_oz_ntt_mul(r0, r0, f[j], precomp);
+  _fmpz_mod_poly_oz_ntt_mul_many(r1, f, len, precomp);
+  r &= fmpz_mod_poly_equal(r0, r1);
+
+  /* f_j·f_j^{-1} = 1 */
+  fmpz_mod_poly_t *h = (fmpz_mod_poly_t*)calloc(len, sizeof(fmpz_mod_poly_t));
+  for(size_t j=0; j<len; j++)
+    fmpz_mod_poly_init(h[j], q);
+  _fmpz_mod_poly_oz_ntt_inv_many(h, f, len, precomp);
+  fmpz_mod_poly_oz_ntt_set_ui(r0, 1, n);
+  for(size_t j=0; j<len; j++) {
+    _fmpz_mod_poly_oz_ntt_mul(r1, f[j], h[j], precomp);
+    r &= fmpz_mod_poly_equal(r0, r1);
+    fmpz_mod_poly_clear(h[j]);
+  }
+  free(h);
+
+  /* single coefficients of INTT(f_0 ⊙ g_0) */
+  _fmpz_mod_poly_oz_ntt_mul(t, f[0], g[0], precomp);
+  fmpz_mod_poly_oz_ntt_dec(t, t, precomp);
+  mp_ptr row = (mp_ptr)malloc(n * precomp->mont->nlimbs * sizeof(mp_limb_t));
+  fmpz_t c0, c1;  fmpz_init(c0);  fmpz_init(c1);
+  for(long j=0; j<n; j+=n/4+1) {
+    _fmpz_mod_poly_oz_ntt_dec_row(row, j, f[0], precomp);
+    _fmpz_mod_poly_oz_ntt_dec_coeff(c1, g[0], row, precomp);
+    fmpz_mod_poly_get_coeff_fmpz(c0, t, j);
+    r &= fmpz_equal(c0, c1);
+  }
+  fmpz_clear(c0);
+  fmpz_clear(c1);
+  free(row);
+
+  printf("n: %6ld, log(q): %6ld, len: %3zu", n, fmpz_sizeinbase(q, 2), len);
+  if (r)
+    printf(" PASS\n");
+  else
+    printf(" FAIL\n");
+
+  fmpz_mod_poly_clear(r1);
+  fmpz_mod_poly_clear(t);
+  fmpz_mod_poly_clear(r0);
+  for(size_t j=0; j<len; j++) {
+    fmpz_mod_poly_clear(f[j]);
+    fmpz_mod_poly_clear(g[j]);
+  }
+  free(f);
+  free(g);
+  fmpz_mod_poly_oz_ntt_precomp_clear(precomp);
+  fmpz_clear(q);
+  return !r;
+}
+
+int main(int argc, char *argv[]) {
+
+  aes_randstate_t state;
+  aes_randinit(state);
+
+  int status = 0;
+
+  for(long n=16; n<=1024; n*=4)
+    for(mp_bitcnt_t bits=64; bits<=4096; bits*=4)
+      for(size_t len=1; len<=64; len*=8)
+        status += test_fmpz_mod_poly_oz_ntt_dot(n, bits, len, state);
+
+  aes_randclear(state);
+  flint_cleanup();
+  return status;
+}
@@ -0,0 +1,105 @@
+#include <utility>
+#include <gghlite/gghlite.hpp>
+
+using gghlite::Cleartext;
+using gghlite::Encoding;
+using gghlite::Key;
+
+static bool
+enc_equal(const Encoding &a, const gghlite_enc_t b)
+{
+    return fmpz_mod_poly_equal(a.get(), b);
+}
+
+int test_hpp(const size_t lambda, aes_randstate_t randstate) {
+
+    printf("λ: %4zu …", lambda);
+
+    Key key(lambda, 2, 1, 0x0, GGHLITE_FLAGS_QUIET, randstate);
+    const struct _gghlite_params_struct *params = key.params();
+
+    int status = 0;
+
+    Encoding a(key), b(key), c(key), d(key), e(key);
+    fmpz_mod_poly_randtest_aes(a.get(), randstate, params->n);
+    fmpz_mod_poly_randtest_aes(b.get(), randstate, params->n);
+    fmpz_mod_poly_randtest_aes(c.get(), randstate, params->n);
+    fmpz_mod_poly_randtest_aes(d.get(), randstate, params->n);
+    fmpz_mod_poly_randtest_aes(e.get(), randstate, params->n);
+
+    gghlite_enc_t r0, t;
+    gghlite_enc_init(r0, params);
+    gghlite_enc_init(t, params);
+
+    /* a*b + c*d - e */
+    gghlite_enc_mul(r0, params, a.get(), b.get());
+    gghlite_enc_mul(t, params, c.get(), d.get());
+    gghlite_enc_add(r0, params, r0, t);
+    gghlite_enc_sub(r0, params, r0, e.get());
+
+    Encoding r = a*b + c*d - e;
+    if (!enc_equal(r, r0))
+        status++;
+
+    /* r = r*a + b reads r while writing it */
+    gghlite_enc_mul(r0, params, r0, a.get());
+    gghlite_enc_add(r0, params, r0, b.get());
+    r = r*a + b;
+    if (!enc_equal(r, r0))
+        status++;
+
+    /* moved-from encodings are zero, the moved-to one holds the value */
+    Encoding m(std::move(r));
+    if (!enc_equal(m, r0) || !fmpz_mod_poly_is_zero(r.get()))
+        status++;
+    Encoding n(key);
+    n = std::move(m);
+    if (!enc_equal(n, r0))
+        status++;
+    Encoding k = n.clone();
+    if (k != n)
+        status++;
+
+    /* encodings keep working after their key is moved */
+    Key other(std::move(key));
+    if (other.params() != params || key.get() != NULL)
+        status++;
+    gghlite_enc_mul(r0, params, k.get(), c.get());
+    Encoding s = k*c;
+    if (!enc_equal(s, r0))
+        status++;
+
+    /* clear texts */
+    Cleartext f;
+    fmpz_poly_set_ui(f.get(), 3);
+    Cleartext g(std::move(f));
+    fmpz_poly_t three;
+    fmpz_poly_init(three);
+    fmpz_poly_set_ui(three, 3);
+    if (!fmpz_poly_equal(g.get(), three) || !fmpz_poly_is_zero(f.get()))
+        status++;
+    fmpz_poly_clear(three);
+
+    gghlite_enc_clear(t);
+    gghlite_enc_clear(r0);
+
+    if (status == 0)
+        printf(" PASS\n");
+    else
+        printf(" FAIL\n");
+
+    return status;
+}
+
+int main(int argc, char *argv[]) {
+    aes_randstate_t randstate;
+    aes_randinit(randstate);
+
+    int status = 0;
+    status += test_hpp(20, randstate);
+
+    aes_randclear(randstate);
+    flint_cleanup();
+    mpfr_free_cache();
+    return status;
+}
@@ -27,6 +27,57 @@ test_instgen_asymm(const size_t lambda, const size_t kappa, const uint64_t reran
 }
 
 
+int
+test_instgen_rerand(const size_t lambda, const size_t kappa, aes_randstate_t randstate)
+{
+    printf("symm: 1, λ: %4zu, κ: %2zu, rerand: 0x%016zx", lambda, kappa, (size_t)1);
+
+    gghlite_sk_t self;
+    const gghlite_flag_t flags = GGHLITE_FLAGS_QUIET;
+    gghlite_init(self, lambda, kappa, 1 /* gamma */, 0x1, flags, randstate);
+
+    gghlite_params_t params;
+    gghlite_params_ref(params, self);
+    gghlite_sk_clear(self, 0);
+
+    int status = 0;
+
+    /* x_j·y^{κ-1} are encodings of zero at level κ */
+    gghlite_enc_t t;
+    gghlite_enc_init(t, params);
+    for(size_t j=0; j<2; j++) {
+        gghlite_enc_raise(t, params, params->x[0][0][j], kappa, 1, 0, 0, randstate);
+        if (!gghlite_enc_is_zero(params, t))  status++;
+    }
+
+    /* two re-randomised encodings of the same element differ but encode the same thing */
+    gghlite_enc_t e, u0, u1;
+    gghlite_enc_init(e, params);
+    gghlite_enc_init(u0, params);
+    gghlite_enc_init(u1, params);
+    gghlite_enc_sample(e, params, 0, 0, randstate);
+    gghlite_enc_raise0(u0, params, e, 1, randstate);
+    gghlite_enc_raise0(u1, params, e, 1, randstate);
+    if (gghlite_enc_equal(params, u0, u1) != 1)  status++;
+    if (fmpz_mod_poly_equal(u0, u1))  status++;
+    gghlite_enc_raise(u0, params, u0, kappa, 1, 0, 0, randstate);
+    gghlite_enc_raise(u1, params, u1, kappa, 1, 0, 0, randstate);
+    if (gghlite_enc_equal(params, u0, u1) != 1)  status++;
+
+    if (status == 0)
+        printf(" (%d) PASS\n", status);
+    else
+        printf(" (%d) FAIL\n", status);
+
+    gghlite_enc_clear(u1);
+    gghlite_enc_clear(u0);
+    gghlite_enc_clear(e);
+    gghlite_enc_clear(t);
+    gghlite_params_clear(params);
+    return status;
+}
+
+
 int
 main(int argc, char *argv[])
 {
@@ -37,6 +88,7 @@ main(int argc, char *argv[])
 
     status += test_instgen_asymm(20, 2, 0x0, randstate);
     status += test_instgen_asymm(20, 4, 0x0, randstate);
+    status += test_instgen_rerand(20, 2, randstate);
 
     aes_randclear(randstate);
     flint_cleanup();
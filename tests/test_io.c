@@ -0,0 +1,167 @@
+#include <gghlite/gghlite.h>
+#include <gghlite/gghlite-internals.h>
+#include <unistd.h>
+
+static int
+params_equal(const gghlite_params_t a, const gghlite_params_t b)
+{
+    if (a->n != b->n || a->kappa != b->kappa || a->gamma != b->gamma)
+        return 0;
+    if (a->flags != b->flags || a->rerand_mask != b->rerand_mask)
+        return 0;
+    if (!fmpz_equal(a->q, b->q) || !fmpz_equal(a->zt_bound2, b->zt_bound2))
+        return 0;
+    if (!mpfr_equal_p(a->sigma, b->sigma) || !mpfr_equal_p(a->sigma_p, b->sigma_p) ||
+        !mpfr_equal_p(a->sigma_s, b->sigma_s) || !mpfr_equal_p(a->xi, b->xi))
+        return 0;
+    if (!fmpz_mod_poly_equal(a->pzt, b->pzt) || !fmpz_mod_poly_equal(a->ntt->phi, b->ntt->phi))
+        return 0;
+    if (a->zt_nrows != b->zt_nrows)
+        return 0;
+    if (a->zt_nrows && memcmp(a->zt_rows, b->zt_rows, a->zt_nrows * a->n * a->ntt->mont->nlimbs * sizeof(mp_limb_t)))
+        return 0;
+    if (a->rerand_mask && !fmpz_mod_poly_equal(a->y[0], b->y[0]))
+        return 0;
+    return 1;
+}
+
+int
+test_io(const size_t lambda, const size_t kappa, const size_t gamma, const uint64_t rerand,
+        const gghlite_flag_t flags, aes_randstate_t randstate)
+{
+    printf("λ: %4zu, κ: %2zu, γ: %2zu, rerand: 0x%016zx, flags: 0x%04x", lambda, kappa, gamma, (size_t)rerand, flags);
+
+    gghlite_sk_t self;
+    gghlite_init(self, lambda, kappa, gamma, rerand, flags | GGHLITE_FLAGS_QUIET, randstate);
+
+    FILE *fh = tmpfile();
+    gghlite_sk_save(self, fh);
+    gghlite_params_save(self->params, fh);
+    rewind(fh);
+
+    gghlite_sk_t other;
+    gghlite_sk_load(other, fh, randstate);
+    gghlite_params_t params;
+    gghlite_params_load(params, fh);
+    fclose(fh);
+
+    char filename[] = "/tmp/test_io_XXXXXX";
+    fh = fdopen(mkstemp(filename), "wb");
+    gghlite_params_save_mappable(self->params, fh);
+    fclose(fh);
+    gghlite_params_t mapped;
+    gghlite_params_map(mapped, filename);
+    unlink(filename);
+
+    int status = 0;
+
+    if (!params_equal(self->params, other->params))  status++;
+    if (!params_equal(self->params, params))  status++;
+
+    if (!fmpz_equal(self->params->q, mapped->q) || !fmpz_equal(self->params->zt_bound2, mapped->zt_bound2))  status++;
+    if (memcmp(self->params->pzt_mpn->coeffs, mapped->pzt_mpn->coeffs,
+               self->params->n * self->params->ntt->mont->nlimbs * sizeof(mp_limb_t)))  status++;
+
+    if (!fmpz_poly_equal(self->g, other->g))  status++;
+    if (!fmpq_poly_equal(self->g_inv, other->g_inv))  status++;
+    if (!fmpz_poly_equal(self->h, other->h))  status++;
+    const size_t bound = (gghlite_sk_is_symmetric(self)) ? 1 : gamma;
+    for(size_t i=0; i<bound; i++) {
+        if (!fmpz_mod_poly_equal(self->z[i], other->z[i]))  status++;
+        if (!fmpz_mod_poly_equal(self->z_inv[i], other->z_inv[i]))  status++;
+    }
+    if (!mpfr_equal_p(self->D_g->sigma, other->D_g->sigma))  status++;
+    if (!fmpq_poly_equal(self->D_g->B_inv, other->D_g->B_inv))  status++;
+    if (!fmpq_poly_equal(self->D_g->sigma_sqrt, other->D_g->sigma_sqrt))  status++;
+
+    /* encodings made with the loaded key zero-test against the original parameters and vice versa */
+    const size_t k = (gghlite_sk_is_symmetric(self)) ? kappa : 1;
+    gghlite_index_t S;
+    gghlite_index_init(S, gamma);
+    for(size_t i=0; i<gamma; i++)
+        gghlite_index_add(S, i);
+
+    gghlite_clr_t f;
+    gghlite_clr_init(f);
+    gghlite_enc_t e;
+    gghlite_enc_init(e, self->params);
+
+    fmpz_poly_sample_D(f, other->D_g, randstate);
+    gghlite_enc_set_gghlite_clr_index(e, other, f, k, S, 0);
+    if (!gghlite_enc_is_zero(self->params, e))  status++;
+    if (!gghlite_enc_is_zero(mapped, e))  status++;
+
+    fmpz_poly_set_ui(f, 1);
+    gghlite_enc_set_gghlite_clr_index(e, self, f, k, S, 0);
+    if (gghlite_enc_is_zero(other->params, e))  status++;
+    if (gghlite_enc_is_zero(params, e))  status++;
+    if (gghlite_enc_is_zero(mapped, e))  status++;
+
+    /* packed encodings round-trip through a buffer and a file descriptor */
+    gghlite_enc_t e2;
+    gghlite_enc_init(e2, self->params);
+    uint8_t *buf = (uint8_t*)malloc(gghlite_enc_packed_size(self->params));
+    gghlite_enc_pack(buf, self->params, e);
+    gghlite_enc_unpack(e2, mapped, buf);
+    if (!gghlite_enc_equal(self->params, e, e2))  status++;
+
+    fh = tmpfile();
+    gghlite_enc_pack_fd(fileno(fh), self->params, e);
+    lseek(fileno(fh), 0, SEEK_SET);
+    gghlite_enc_unpack_fd(e2, self->params, fileno(fh));
+    fclose(fh);
+    if (!gghlite_enc_equal(self->params, e, e2))  status++;
+    free(buf);
+
+    /* stores hand out views which the kernels of mapped params consume */
+    char storename[] = "/tmp/test_io_XXXXXX";
+    close(mkstemp(storename));
+    gghlite_store_t store;
+    gghlite_store_create(store, self->params, storename);
+    gghlite_store_append(store, 1, 2, 3, e);
+    gghlite_store_append(store, 0, 7, 0, e2);
+    gghlite_store_clear(store);
+    gghlite_store_open(store, mapped, storename);
+    unlink(storename);
+
+    gghlite_enc_mpn_view_t view;
+    if (!gghlite_store_get(view, store, 1, 2, 3))  status++;
+    if (gghlite_enc_mpn_is_zero(mapped, view))  status++;
+    gghlite_enc_set_gghlite_enc_mpn(e2, mapped, view);
+    if (!gghlite_enc_equal(self->params, e, e2))  status++;
+    if (gghlite_store_get(view, store, 1, 2, 4))  status++;
+    gghlite_store_clear(store);
+    gghlite_enc_clear(e2);
+
+    if (status == 0)
+        printf(" (%d) PASS\n", status);
+    else
+        printf(" (%d) FAIL\n", status);
+
+    gghlite_enc_clear(e);
+    gghlite_clr_clear(f);
+    gghlite_index_clear(S);
+    gghlite_params_clear(mapped);
+    gghlite_params_clear(params);
+    gghlite_sk_clear(other, 1);
+    gghlite_sk_clear(self, 1);
+    return status;
+}
+
+int
+main(int argc, char *argv[])
+{
+    aes_randstate_t randstate;
+    aes_randinit(randstate);
+
+    int status = 0;
+
+    status += test_io(20, 2, 1, 0x1, GGHLITE_FLAGS_ZT_PRECHECK, randstate);
+    status += test_io(20, 3, 3, 0x0, GGHLITE_FLAGS_ASYMMETRIC | GGHLITE_FLAGS_NTT_SEEDED, randstate);
+    status += test_io(20, 2, 1, 0x0, GGHLITE_FLAGS_RNS, randstate);
+
+    aes_randclear(randstate);
+    flint_cleanup();
+    mpfr_free_cache();
+    return status;
+}
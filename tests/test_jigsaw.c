@@ -3,15 +3,66 @@
 
 #define GAMMA (100)
 
+/* gghlite_enc_extract against [p_zt·f]_q lifted to (-q/2, q/2) and shifted down to ℓ bits */
+static int
+extract_equal_ref(const gghlite_params_t params, const gghlite_enc_t f)
+{
+    gghlite_clr_t raw, ext;
+    gghlite_clr_init(raw);
+    gghlite_clr_init(ext);
+    fmpz_t q2;  fmpz_init(q2);
+    fmpz_fdiv_q_2exp(q2, params->q, 1);
+    const long logq = fmpz_sizeinbase(params->q, 2) - 1;
+    const long shift = (logq > params->ell) ? logq - params->ell : 0;
+
+    _gghlite_enc_extract_raw(raw, params, f);
+    for(long i=0; i<raw->length; i++) {
+        fmpz *c = raw->coeffs + i;
+        if (fmpz_cmp(c, q2) > 0)
+            fmpz_sub(c, c, params->q);
+        fmpz_tdiv_q_2exp(c, c, shift);
+    }
+    _fmpz_poly_normalise(raw);
+
+    gghlite_enc_extract(ext, params, f);
+    const int r = fmpz_poly_equal(raw, ext);
+
+    fmpz_clear(q2);
+    gghlite_clr_clear(ext);
+    gghlite_clr_clear(raw);
+    return r;
+}
+
+typedef struct {
+    unsigned char *buf;
+    size_t len;
+} extract_bytes_t;
+
+static void
+extract_bytes_update(void *ctx, const unsigned char *buf, size_t len)
+{
+    extract_bytes_t *h = (extract_bytes_t*)ctx;
+    h->buf = (unsigned char*)realloc(h->buf, h->len + len);
+    memcpy(h->buf + h->len, buf, len);
+    h->len += len;
+}
+
+static int
+extract_bytes_equal(const extract_bytes_t *a, const extract_bytes_t *b)
+{
+    return a->len == b->len && memcmp(a->buf, b->buf, a->len) == 0;
+}
+
 /**
  * Testing the flexibility of large index sets with a smaller kappa
  */
-int test_jigsaw_indices(const size_t lambda, const size_t kappa, const size_t gamma, aes_randstate_t randstate) {
+int test_jigsaw_indices(const size_t lambda, const size_t kappa, const size_t gamma, const gghlite_flag_t flags,
+                        aes_randstate_t randstate) {
 
-	printf("lambda: %d, kappa: %d, gamma: %d", (int) lambda, (int) kappa, (int) gamma);
+	printf("lambda: %d, kappa: %d, gamma: %d, precheck: %d", (int) lambda, (int) kappa, (int) gamma,
+	       (flags & GGHLITE_FLAGS_ZT_PRECHECK) ? 1 : 0);
 
     gghlite_sk_t self;
-    gghlite_flag_t flags = GGHLITE_FLAGS_QUIET;
 
     gghlite_jigsaw_init_gamma(self, lambda, kappa, gamma, flags, randstate);
 
@@ -73,8 +124,30 @@ int test_jigsaw_indices(const size_t lambda, const size_t kappa, const size_t ga
         gghlite_enc_mul(rght, self->params, rght, self->z_inv[k]);
     }
  
-    gghlite_enc_sub(rght, self->params, rght, left);
-    int status = 1 - gghlite_enc_is_zero(self->params, rght);
+    int status = 1 - gghlite_enc_equal(self->params, rght, left);
+    /* a non-zero top-level element must not pass the zero-test, with or without the pre-check */
+    status |= gghlite_enc_is_zero(self->params, left);
+
+    /* the same product in one pass */
+    gghlite_enc_t many;
+    gghlite_enc_init(many, self->params);
+    gghlite_enc_mul_many(many, self->params, u, kappa);
+    status |= !fmpz_mod_poly_equal(many, left);
+    gghlite_enc_clear(many);
+
+    /* again via index sets, all products of z_i^{-1} now come from the cache */
+    gghlite_index_t S;
+    gghlite_index_init(S, gamma);
+    for(size_t k=0; k<kappa; k++) {
+        gghlite_index_zero(S);
+        for (size_t j = 0; j < gamma; j++)
+            if (partition[j] == k)
+                gghlite_index_add(S, j);
+        gghlite_enc_set_gghlite_clr_index(u[k], self, e[k], 1, S, 1);
+    }
+    gghlite_index_clear(S);
+    gghlite_enc_mul_many(left, self->params, u, kappa);
+    status |= 1 - gghlite_enc_equal(self->params, rght, left);
 
     for(size_t i=0; i<kappa; i++) {
         fmpz_clear(a[i]);
@@ -157,8 +230,48 @@ int test_jigsaw(const size_t lambda, const size_t kappa, int symmetric, aes_rand
         gghlite_enc_mul(rght, self->params, rght, self->z_inv[i]);
     }
 
+    /* extraction, the same product in reverse order and twice the product as hash input */
+    int status = 1 - extract_equal_ref(self->params, left);
+    gghlite_enc_t rev, twice;
+    gghlite_enc_init(rev, self->params);
+    gghlite_enc_init(twice, self->params);
+    gghlite_enc_set_ui0(rev, 1, self->params);
+    for(size_t k=kappa; k>0; k--)
+        gghlite_enc_mul(rev, self->params, rev, u[k-1]);
+    gghlite_enc_add(twice, self->params, left, left);
+    extract_bytes_t h[3] = {{NULL, 0}, {NULL, 0}, {NULL, 0}};
+    gghlite_enc_extract_hash(self->params, left, extract_bytes_update, h + 0);
+    gghlite_enc_extract_hash(self->params, rev, extract_bytes_update, h + 1);
+    gghlite_enc_extract_hash(self->params, twice, extract_bytes_update, h + 2);
+    status |= !extract_bytes_equal(h + 0, h + 1) || extract_bytes_equal(h + 0, h + 2);
+    for(size_t j=0; j<3; j++)
+        free(h[j].buf);
+    gghlite_enc_clear(twice);
+    gghlite_enc_clear(rev);
+
     gghlite_enc_sub(rght, self->params, rght, left);
-    int status = 1 - gghlite_enc_is_zero(self->params, rght);
+    status |= 1 - gghlite_enc_is_zero(self->params, rght);
+
+    /* batched zero-tests agree with single ones on zero and non-zero encodings */
+    gghlite_enc_t batch[4];
+    int zero[4];
+    for(size_t j=0; j<4; j++)
+        gghlite_enc_init(batch[j], self->params);
+    fmpz_mod_poly_set(batch[0], rght);
+    fmpz_mod_poly_set(batch[1], left);
+    gghlite_enc_add(batch[2], self->params, left, left);
+    gghlite_enc_sub(batch[3], self->params, left, left);
+    gghlite_enc_is_zero_batch(zero, self->params, batch, 4);
+    gghlite_enc_mpn_t batch_mpn;
+    gghlite_enc_mpn_init(batch_mpn, self->params);
+    for(size_t j=0; j<4; j++) {
+        status |= zero[j] != gghlite_enc_is_zero(self->params, batch[j]);
+        gghlite_enc_mpn_set_gghlite_enc(batch_mpn, self->params, batch[j]);
+        status |= zero[j] != gghlite_enc_mpn_is_zero(self->params, batch_mpn->view);
+        gghlite_enc_clear(batch[j]);
+    }
+    gghlite_enc_mpn_clear(batch_mpn);
+    status |= !zero[0] || zero[1] || zero[2] || !zero[3];
 
     for(size_t i=0; i<kappa; i++) {
         fmpz_clear(a[i]);
@@ -195,8 +308,9 @@ int main(int argc, char *argv[]) {
     status += test_jigsaw(20, 3, 0, randstate);
     status += test_jigsaw(20, 4, 0, randstate);
 
-    status += test_jigsaw_indices(20, 4, 90, randstate);
-    status += test_jigsaw_indices(20, 20, 60, randstate);
+    status += test_jigsaw_indices(20, 4, 90, GGHLITE_FLAGS_QUIET, randstate);
+    status += test_jigsaw_indices(20, 4, 90, GGHLITE_FLAGS_QUIET | GGHLITE_FLAGS_ZT_PRECHECK, randstate);
+    status += test_jigsaw_indices(20, 20, 60, GGHLITE_FLAGS_QUIET, randstate);
 
 
 
@@ -0,0 +1,145 @@
+#include <gghlite/gghlite.h>
+
+static void
+mat_randtest(gghlite_enc_mat_t m, const gghlite_params_t self, aes_randstate_t randstate)
+{
+    for(size_t k=0; k<m->nrows*m->ncols; k++)
+        fmpz_mod_poly_randtest_aes(m->entries[k], randstate, self->n);
+}
+
+/* entry by entry with gghlite_enc_mul and gghlite_enc_add */
+static void
+mat_mul_ref(gghlite_enc_mat_t rop, const gghlite_params_t self, const gghlite_enc_mat_t a, const gghlite_enc_mat_t b)
+{
+    gghlite_enc_t t;
+    gghlite_enc_init(t, self);
+    for(size_t i=0; i<a->nrows; i++) {
+        for(size_t j=0; j<b->ncols; j++) {
+            fmpz_mod_poly_struct *c = gghlite_enc_mat_entry(rop, i, j);
+            fmpz_mod_poly_zero(c);
+            for(size_t l=0; l<a->ncols; l++) {
+                gghlite_enc_mul(t, self, gghlite_enc_mat_entry(a, i, l), gghlite_enc_mat_entry(b, l, j));
+                gghlite_enc_add(c, self, c, t);
+            }
+        }
+    }
+    gghlite_enc_clear(t);
+}
+
+static int
+mat_equal(const gghlite_enc_mat_t a, const gghlite_enc_mat_t b)
+{
+    if (a->nrows != b->nrows || a->ncols != b->ncols)
+        return 0;
+    for(size_t k=0; k<a->nrows*a->ncols; k++)
+        if (!fmpz_mod_poly_equal(a->entries[k], b->entries[k]))
+            return 0;
+    return 1;
+}
+
+int test_mat(const size_t lambda, const size_t w, const size_t count, aes_randstate_t randstate) {
+
+    printf("λ: %4zu, w: %2zu, count: %3zu …", lambda, w, count);
+
+    gghlite_sk_t self;
+    gghlite_init(self, lambda, 2, 1, 0x0, GGHLITE_FLAGS_QUIET, randstate);
+    gghlite_params_t params;
+    gghlite_params_ref(params, self);
+    gghlite_sk_clear(self, 0);
+
+    int status = 0;
+
+    /* bookended chain 1×w · w×w · … · w×1 */
+    gghlite_enc_mat_t m[count];
+    for(size_t i=0; i<count; i++) {
+        gghlite_enc_mat_init(m[i], params, (i == 0) ? 1 : w, (i == count-1) ? 1 : w);
+        mat_randtest(m[i], params, randstate);
+    }
+
+    gghlite_enc_mat_t a, t;
+    gghlite_enc_mat_init(a, params, 1, w);
+    gghlite_enc_mat_set(a, m[0]);
+    for(size_t i=1; i<count; i++) {
+        gghlite_enc_mat_init(t, params, 1, m[i]->ncols);
+        mat_mul_ref(t, params, a, m[i]);
+        gghlite_enc_mat_swap(a, t);
+        gghlite_enc_mat_clear(t);
+    }
+
+    gghlite_enc_mat_init(t, params, 1, 1);
+    gghlite_enc_mat_mul_many(t, params, m, count);
+    if (!mat_equal(a, t))
+        status++;
+    gghlite_enc_mat_clear(t);
+    gghlite_enc_mat_clear(a);
+
+    /* column chain w×w · … · w×w · w×1 of an odd number of factors, accumulated from the right */
+    const size_t odd = count | 1;
+    gghlite_enc_mat_t c[odd];
+    for(size_t i=0; i<odd; i++) {
+        gghlite_enc_mat_init(c[i], params, w, (i == odd-1) ? 1 : w);
+        mat_randtest(c[i], params, randstate);
+    }
+
+    gghlite_enc_mat_init(a, params, w, w);
+    gghlite_enc_mat_set(a, c[0]);
+    for(size_t i=1; i<odd; i++) {
+        gghlite_enc_mat_init(t, params, w, c[i]->ncols);
+        gghlite_enc_mat_mul(t, params, a, c[i]);
+        gghlite_enc_mat_swap(a, t);
+        gghlite_enc_mat_clear(t);
+    }
+
+    gghlite_enc_mat_init(t, params, w, 1);
+    gghlite_enc_mat_mul_many(t, params, c, odd);
+    if (!mat_equal(a, t))
+        status++;
+    gghlite_enc_mat_clear(t);
+    gghlite_enc_mat_clear(a);
+    for(size_t i=0; i<odd; i++)
+        gghlite_enc_mat_clear(c[i]);
+
+    /* square products, in place */
+    gghlite_enc_mat_init(a, params, w, w);
+    gghlite_enc_mat_init(t, params, w, w);
+    mat_mul_ref(t, params, m[1], m[1]);
+    gghlite_enc_mat_set(a, m[1]);
+    gghlite_enc_mat_mul(a, params, a, a);
+    if (!mat_equal(a, t))
+        status++;
+    gghlite_enc_mat_clear(t);
+
+    /* matrix-vector, the vector is the last column of the chain */
+    gghlite_enc_mat_init(t, params, w, 1);
+    mat_mul_ref(t, params, m[1], m[count-1]);
+    gghlite_enc_mat_mul_vec(m[count-1]->entries, params, m[1], m[count-1]->entries);
+    if (!mat_equal(m[count-1], t))
+        status++;
+
+    gghlite_enc_mat_clear(t);
+    gghlite_enc_mat_clear(a);
+    for(size_t i=0; i<count; i++)
+        gghlite_enc_mat_clear(m[i]);
+    gghlite_params_clear(params);
+
+    if (status == 0)
+        printf(" PASS\n");
+    else
+        printf(" FAIL\n");
+
+    return status;
+}
+
+int main(int argc, char *argv[]) {
+    aes_randstate_t randstate;
+    aes_randinit(randstate);
+
+    int status = 0;
+    status += test_mat(20, 5, 3, randstate);
+    status += test_mat(20, 6, 16, randstate);
+
+    aes_randclear(randstate);
+    flint_cleanup();
+    mpfr_free_cache();
+    return status;
+}
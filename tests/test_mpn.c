@@ -0,0 +1,140 @@
+#include <oz/oz.h>
+#include <oz/util.h>
+#include <oz/flint-addons.h>
+
+int test_fmpz_mod_poly_oz_mpn(long n, mp_bitcnt_t bits, aes_randstate_t state) {
+
+  fmpz_t q;
+  fmpz_init(q);
+  fmpz_randbits_aes(q, state, bits);
+  fmpz_abs(q, q);
+  fmpz_fdiv_q_2exp(q, q, n_flog(n,2)+1);
+  fmpz_mul_2exp(q, q, n_flog(n,2)+1);
+  fmpz_add_ui(q, q, 1);
+  while (!fmpz_is_probabprime(q))
+    fmpz_add_ui(q, q, 2*n);
+
+  fmpz_mod_poly_oz_ntt_precomp_t precomp;
+  fmpz_mod_poly_oz_ntt_precomp_init(precomp, n, q);
+
+  fmpz_mod_poly_t f0;  fmpz_mod_poly_init(f0, q);
+  fmpz_mod_poly_t f1;  fmpz_mod_poly_init(f1, q);
+
+  fmpz_mod_poly_randtest_aes(f0, state, n);
+  while (fmpz_mod_poly_degree(f0) < n-1)
+    fmpz_mod_poly_randtest_aes(f0, state, n);
+
+  fmpz_mod_poly_randtest_aes(f1, state, n);
+  while (fmpz_mod_poly_degree(f1) < n-1)
+    fmpz_mod_poly_randtest_aes(f1, state, n);
+
+  /* reference results */
+  fmpz_mod_poly_t r0;  fmpz_mod_poly_init(r0, q);
+  _fmpz_mod_poly_oz_mul_nttnwc(r0, f0, f1, precomp);
+  fmpz_mod_poly_t s0;  fmpz_mod_poly_init(s0, q);
+  fmpz_mod_poly_add(s0, f0, f1);
+
+  fmpz_mod_poly_oz_mpn_t F0;  fmpz_mod_poly_oz_mpn_init(F0, precomp);
+  fmpz_mod_poly_oz_mpn_t F1;  fmpz_mod_poly_oz_mpn_init(F1, precomp);
+  fmpz_mod_poly_oz_mpn_t S;   fmpz_mod_poly_oz_mpn_init(S, precomp);
+  fmpz_mod_poly_oz_mpn_set_fmpz_mod_poly(F0, f0, precomp);
+  fmpz_mod_poly_oz_mpn_set_fmpz_mod_poly(F1, f1, precomp);
+
+  fmpz_mod_poly_t t;  fmpz_mod_poly_init(t, q);
+
+  fmpz_mod_poly_oz_mpn_add(S, F0->view, F1->view, precomp);
+  fmpz_mod_poly_oz_mpn_get_fmpz_mod_poly(t, S->view, precomp);
+  int r = fmpz_mod_poly_equal(t, s0);
+
+  fmpz_mod_poly_oz_mpn_sub(S, S->view, F1->view, precomp);
+  fmpz_mod_poly_oz_mpn_get_fmpz_mod_poly(t, S->view, precomp);
+  r &= fmpz_mod_poly_equal(t, f0);
+
+  /* both NTT domains agree */
+  fmpz_mod_poly_oz_mpn_ntt_enc(F0, F0->view, precomp);
+  fmpz_mod_poly_oz_mpn_ntt_enc(F1, F1->view, precomp);
+  fmpz_mod_poly_oz_ntt_enc(s0, f0, precomp);
+  fmpz_mod_poly_oz_mpn_get_fmpz_mod_poly(t, F0->view, precomp);
+  r &= fmpz_mod_poly_equal(t, s0);
+
+  fmpz_mod_poly_oz_mpn_mul(F0, F0->view, F1->view, precomp);
+  fmpz_mod_poly_oz_mpn_ntt_dec(F0, F0->view, precomp);
+  fmpz_mod_poly_oz_mpn_get_fmpz_mod_poly(t, F0->view, precomp);
+  r &= fmpz_mod_poly_equal(t, r0);
+
+  fmpz_mod_poly_oz_mpn_sub(S, F0->view, F0->view, precomp);
+  r &= fmpz_mod_poly_oz_mpn_is_zero(S->view);
+
+  /* four-step and radix-2 transforms agree */
+  precomp->four_step = (precomp->four_step <= (size_t)n) ? SIZE_MAX : 4;
+  fmpz_mod_poly_oz_mpn_set_fmpz_mod_poly(S, f0, precomp);
+  fmpz_mod_poly_oz_mpn_ntt_enc(S, S->view, precomp);
+  fmpz_mod_poly_oz_mpn_get_fmpz_mod_poly(t, S->view, precomp);
+  r &= fmpz_mod_poly_equal(t, s0);
+  fmpz_mod_poly_oz_mpn_ntt_dec(S, S->view, precomp);
+  fmpz_mod_poly_oz_mpn_get_fmpz_mod_poly(t, S->view, precomp);
+  r &= fmpz_mod_poly_equal(t, f0);
+
+  /* compact pre-computations give the same results */
+  const oz_flag_t compact_flags[2] = {OZ_NTT_COMPACT, OZ_NTT_COMPACT | OZ_NTT_SEEDED};
+  for(int i=0; i<2; i++) {
+    fmpz_mod_poly_oz_ntt_precomp_t compact;
+    fmpz_mod_poly_oz_ntt_precomp_init_flags(compact, n, q, compact_flags[i]);
+    for(int four_step=0; four_step<2; four_step++) {
+      compact->four_step = four_step ? 4 : SIZE_MAX;
+      fmpz_mod_poly_oz_mpn_set_fmpz_mod_poly(S, f0, compact);
+      fmpz_mod_poly_oz_mpn_ntt_enc(S, S->view, compact);
+      fmpz_mod_poly_oz_mpn_get_fmpz_mod_poly(t, S->view, compact);
+      r &= fmpz_mod_poly_equal(t, s0);
+      fmpz_mod_poly_oz_mpn_ntt_dec(S, S->view, compact);
+      fmpz_mod_poly_oz_mpn_get_fmpz_mod_poly(t, S->view, compact);
+      r &= fmpz_mod_poly_equal(t, f0);
+    }
+    _fmpz_mod_poly_oz_mul_nttnwc(t, f0, f1, compact);
+    r &= fmpz_mod_poly_equal(t, r0);
+    fmpz_mod_poly_oz_ntt_precomp_clear(compact);
+  }
+
+  /* cached pre-computations are shared and give the same results */
+  const struct fmpz_mod_poly_oz_ntt_precomp_struct *cached = fmpz_mod_poly_oz_ntt_precomp_get(n, q);
+  r &= (cached == fmpz_mod_poly_oz_ntt_precomp_get(n, q));
+  fmpz_mod_poly_oz_ntt_precomp_put(cached);
+  fmpz_mod_poly_oz_ntt_precomp_put(cached);
+  fmpz_mod_poly_oz_mul_nttnwc(t, f0, f1, n);
+  r &= fmpz_mod_poly_equal(t, r0);
+  r &= (fmpz_mod_poly_oz_ntt_precomp_cache_clear() == 0);
+
+  printf("n: %6ld, log(q): %6ld", n, fmpz_sizeinbase(q, 2));
+  if (r)
+    printf(" PASS\n");
+  else
+    printf(" FAIL\n");
+
+  fmpz_mod_poly_clear(t);
+  fmpz_mod_poly_oz_mpn_clear(S);
+  fmpz_mod_poly_oz_mpn_clear(F1);
+  fmpz_mod_poly_oz_mpn_clear(F0);
+  fmpz_mod_poly_clear(s0);
+  fmpz_mod_poly_clear(r0);
+  fmpz_mod_poly_clear(f1);
+  fmpz_mod_poly_clear(f0);
+  fmpz_mod_poly_oz_ntt_precomp_clear(precomp);
+  fmpz_clear(q);
+  return !r;
+}
+
+int main(int argc, char *argv[]) {
+
+  aes_randstate_t state;
+  aes_randinit(state);
+
+  int status = 0;
+
+  for(long n=16; n<=1024; n*=4)
+    for(mp_bitcnt_t bits=64; bits<=4096; bits*=4)
+      status += test_fmpz_mod_poly_oz_mpn(n, bits, state);
+
+  aes_randclear(state);
+  flint_cleanup();
+  return status;
+}
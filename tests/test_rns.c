@@ -0,0 +1,99 @@
+#include <oz/oz.h>
+#include <oz/util.h>
+#include <oz/flint-addons.h>
+
+int test_fmpz_mod_poly_oz_rns(long n, size_t k, aes_randstate_t state) {
+
+  mp_limb_t *primes = (mp_limb_t*)calloc(k, sizeof(mp_limb_t));
+  mp_limb_t p = ((UWORD(1)<<OZ_RNS_PRIME_BITS)/(2*n))*(2*n) + 1;
+  for(size_t i=0; i<k; i++) {
+    p = _n_prev_oz_good_probaprime(p, 2*n);
+    primes[i] = p;
+  }
+
+  fmpz_mod_poly_oz_ntt_precomp_t ntt;
+  fmpz_mod_poly_oz_ntt_precomp_init_crt(ntt, n, primes, k);
+  const fmpz *q = fmpz_mod_poly_modulus(ntt->phi);
+
+  fmpz_mod_poly_oz_rns_precomp_t rns;
+  fmpz_mod_poly_oz_rns_precomp_init(rns, ntt, primes, k);
+
+  fmpz_mod_poly_t f0;  fmpz_mod_poly_init(f0, q);
+  fmpz_mod_poly_t f1;  fmpz_mod_poly_init(f1, q);
+
+  fmpz_mod_poly_randtest_aes(f0, state, n);
+  while (fmpz_mod_poly_degree(f0) < n-1)
+    fmpz_mod_poly_randtest_aes(f0, state, n);
+
+  fmpz_mod_poly_randtest_aes(f1, state, n);
+  while (fmpz_mod_poly_degree(f1) < n-1)
+    fmpz_mod_poly_randtest_aes(f1, state, n);
+
+  /* reference result */
+  fmpz_mod_poly_t r0;  fmpz_mod_poly_init(r0, q);
+  _fmpz_mod_poly_oz_mul_nttnwc(r0, f0, f1, ntt);
+
+  /* multiply modulo each p_i */
+  fmpz_poly_t t0;  fmpz_poly_init(t0);
+  fmpz_poly_t t1;  fmpz_poly_init(t1);
+  fmpz_poly_set_fmpz_mod_poly(t0, f0);
+  fmpz_poly_set_fmpz_mod_poly(t1, f1);
+
+  fmpz_mod_poly_oz_rns_t F0;  fmpz_mod_poly_oz_rns_init(F0, rns);
+  fmpz_mod_poly_oz_rns_t F1;  fmpz_mod_poly_oz_rns_init(F1, rns);
+  fmpz_mod_poly_oz_rns_enc_fmpz_poly(F0, t0, rns);
+  fmpz_mod_poly_oz_rns_enc_fmpz_poly(F1, t1, rns);
+  fmpz_mod_poly_oz_rns_mul(F0, F0, F1, rns);
+
+  fmpz_poly_t s;  fmpz_poly_init(s);
+  fmpz_mod_poly_oz_rns_dec_fmpz_poly(s, F0, rns);
+  fmpz_mod_poly_t r1;  fmpz_mod_poly_init(r1, q);
+  fmpz_mod_poly_set_fmpz_poly(r1, s);
+
+  int r = fmpz_mod_poly_equal(r0, r1);
+
+  /* both NTT domains agree */
+  fmpz_mod_poly_t G;  fmpz_mod_poly_init(G, q);
+  fmpz_mod_poly_oz_ntt_enc(G, f1, ntt);
+  fmpz_mod_poly_t H;  fmpz_mod_poly_init(H, q);
+  fmpz_mod_poly_oz_rns_get_fmpz_mod_poly(H, F1, rns);
+  r &= fmpz_mod_poly_equal(G, H);
+
+  printf("n: %6ld, k: %3zu, log(q): %6ld", n, k, fmpz_sizeinbase(q, 2));
+  if (r)
+    printf(" PASS\n");
+  else
+    printf(" FAIL\n");
+
+  fmpz_mod_poly_clear(H);
+  fmpz_mod_poly_clear(G);
+  fmpz_mod_poly_clear(r1);
+  fmpz_poly_clear(s);
+  fmpz_mod_poly_oz_rns_clear(F1);
+  fmpz_mod_poly_oz_rns_clear(F0);
+  fmpz_poly_clear(t1);
+  fmpz_poly_clear(t0);
+  fmpz_mod_poly_clear(r0);
+  fmpz_mod_poly_clear(f1);
+  fmpz_mod_poly_clear(f0);
+  fmpz_mod_poly_oz_rns_precomp_clear(rns);
+  fmpz_mod_poly_oz_ntt_precomp_clear(ntt);
+  free(primes);
+  return !r;
+}
+
+int main(int argc, char *argv[]) {
+
+  aes_randstate_t state;
+  aes_randinit(state);
+
+  int status = 0;
+
+  for(long n=16; n<=1024; n*=4)
+    for(size_t k=2; k<=32; k*=2)
+      status += test_fmpz_mod_poly_oz_rns(n, k, state);
+
+  aes_randclear(state);
+  flint_cleanup();
+  return status;
+}